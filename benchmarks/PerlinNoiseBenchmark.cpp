@@ -0,0 +1,112 @@
+//
+// Created by Lucas Wang on 2024-10-02.
+//
+
+// Per-sample cost of the 2D noise paths Terrain uses, and bit-exactness checks of noise2D() and
+// latticeNoise2D() against the 3D slices they stand for. Build with -DTERRAINRENDERING_BUILD_BENCHMARKS=ON and run
+// PerlinNoiseBenchmark [samples]; timings are only meaningful for optimized builds.
+
+#include "PerlinNoise.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static const siv::PerlinNoise::seed_type kSeed = 123456u;
+static const std::int32_t kOctaves = 10;
+// Terrain samples at grid / 20 * 0.1
+static const double kSpacing = 0.005;
+
+// Keeps the compiler from dropping the measured calls
+static volatile double s_sink;
+
+template <typename Function>
+static void Measure(const char* name, std::size_t samples, Function&& function) {
+    // One untimed pass warms the caches and the CPU frequency
+    function();
+    auto start = Clock::now();
+    double sum = function();
+    double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    s_sink = sum;
+    std::printf("%-36s %8.1f ns/sample\n", name, elapsed / static_cast<double>(samples));
+}
+
+int main(int argc, char** argv) {
+    const std::size_t samples = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1u << 20;
+    const std::size_t rowLength = 257;
+    const std::size_t rows = (samples + rowLength - 1) / rowLength;
+    const siv::PerlinNoise perlin{ kSeed };
+
+    auto x = [&](std::size_t i) { return static_cast<double>(i % rowLength) * kSpacing; };
+    auto y = [&](std::size_t i) { return static_cast<double>(i / rowLength) * kSpacing; };
+
+    Measure("noise3D(x, y, SIVPERLIN_DEFAULT_Z)", samples, [&] {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < samples; ++i) {
+            sum += perlin.noise3D(x(i), y(i), SIVPERLIN_DEFAULT_Z);
+        }
+        return sum;
+    });
+    Measure("noise2D", samples, [&] {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < samples; ++i) {
+            sum += perlin.noise2D(x(i), y(i));
+        }
+        return sum;
+    });
+    Measure("latticeNoise2D", samples, [&] {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < samples; ++i) {
+            sum += perlin.latticeNoise2D(x(i), y(i));
+        }
+        return sum;
+    });
+    Measure("octave2D_01, 10 octaves", samples, [&] {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < samples; ++i) {
+            sum += perlin.octave2D_01(x(i), y(i), kOctaves);
+        }
+        return sum;
+    });
+    Measure("octave2D_01<10>", samples, [&] {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < samples; ++i) {
+            sum += perlin.octave2D_01<kOctaves>(x(i), y(i));
+        }
+        return sum;
+    });
+
+    std::vector<double> xs(rowLength);
+    std::vector<double> out(rowLength);
+    for (std::size_t i = 0; i < rowLength; ++i) {
+        xs[i] = x(i);
+    }
+    Measure("octave2D_01Row<10>, 257-sample rows", rows * rowLength, [&] {
+        double sum = 0.0;
+        for (std::size_t row = 0; row < rows; ++row) {
+            perlin.octave2D_01Row<kOctaves>(xs.data(), static_cast<double>(row) * kSpacing, rowLength, out.data());
+            sum += out[row % rowLength];
+        }
+        return sum;
+    });
+
+    // latticeNoise2D() is the z = 0 slice of noise3D(), and noise2D() the z = SIVPERLIN_DEFAULT_Z
+    // slice unless it was switched to the lattice kernel
+    std::size_t latticeMismatches = 0;
+    std::size_t sliceMismatches = 0;
+    for (std::size_t i = 0; i < samples; ++i) {
+        const double sx = x(i) * 37.0;
+        const double sy = y(i) * 37.0;
+        latticeMismatches += perlin.latticeNoise2D(sx, sy) != perlin.noise3D(sx, sy, 0.0);
+# ifdef SIVPERLIN_LATTICE_NOISE2D
+        sliceMismatches += perlin.noise2D(sx, sy) != perlin.latticeNoise2D(sx, sy);
+# else
+        sliceMismatches += perlin.noise2D(sx, sy) != perlin.noise3D(sx, sy, SIVPERLIN_DEFAULT_Z);
+# endif
+    }
+    std::printf("latticeNoise2D vs noise3D mismatches: %zu of %zu\n", latticeMismatches, samples);
+    std::printf("noise2D vs its slice mismatches: %zu of %zu\n", sliceMismatches, samples);
+    return latticeMismatches == 0 && sliceMismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,101 @@
+#version 410 core
+// Geometry clipmap level: a gridSize x gridSize grid whose positions come from gl_VertexID and
+// whose heights are read from the level's layer of a toroidally addressed height texture
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+out mat3 TBN;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform sampler2D dispMap;
+
+uniform sampler2DArray heightLevels;
+uniform int level;
+uniform int gridSize;
+uniform int originX;
+uniform int originZ;
+uniform float levelSpacing;
+// The next coarser level, when there is one; each level's heights are band-limited to its own
+// spacing, so the blend has to read the coarser level's samples rather than assume them
+uniform bool hasCoarser;
+uniform int coarseOriginX;
+uniform int coarseOriginZ;
+uniform vec3 cameraPos;
+uniform float texScale;
+uniform float blendWidth;
+
+// grid is in the given level's grid coordinates
+float fetchLevelHeight(int layer, ivec2 origin, ivec2 grid)
+{
+    grid = clamp(grid, origin, origin + ivec2(gridSize - 1));
+    // Origins go negative with the camera, and % on negative ints is undefined in GLSL, so the
+    // toroidal wrap floors instead
+    ivec2 texel = grid - gridSize * ivec2(floor(vec2(grid) / float(gridSize)));
+    return texelFetch(heightLevels, ivec3(texel, layer), 0).r;
+}
+
+float fetchHeight(ivec2 local)
+{
+    ivec2 origin = ivec2(originX, originZ);
+    return fetchLevelHeight(level, origin, origin + local);
+}
+
+// Height of the coarser level at a local point of this level that lies on its grid (both
+// coordinates even)
+float fetchCoarseHeight(ivec2 local)
+{
+    if (!hasCoarser) {
+        return fetchHeight(local);
+    }
+    return fetchLevelHeight(level + 1, ivec2(coarseOriginX, coarseOriginZ), (ivec2(originX, originZ) + local) / 2);
+}
+
+void main()
+{
+    ivec2 local = ivec2(gl_VertexID % gridSize, gl_VertexID / gridSize);
+    vec2 worldXZ = vec2(ivec2(originX, originZ) + local) * levelSpacing;
+    float height = fetchHeight(local);
+
+    // Near the outer edge the height blends into what the next coarser level shows there, so
+    // vertices between its samples end up on its edges and the seam has no cracks. Origins are
+    // even, so odd local coordinates are the ones the coarser grid lacks.
+    ivec2 odd = local & 1;
+    float coarseHeight;
+    if (odd.x == 1 && odd.y == 1) {
+        // Centre of a coarse quad, on the diagonal its two triangles share
+        coarseHeight = 0.5 * (fetchCoarseHeight(local + ivec2(1, -1)) + fetchCoarseHeight(local + ivec2(-1, 1)));
+    } else if (odd.x == 1) {
+        coarseHeight = 0.5 * (fetchCoarseHeight(local - ivec2(1, 0)) + fetchCoarseHeight(local + ivec2(1, 0)));
+    } else if (odd.y == 1) {
+        coarseHeight = 0.5 * (fetchCoarseHeight(local - ivec2(0, 1)) + fetchCoarseHeight(local + ivec2(0, 1)));
+    } else {
+        coarseHeight = fetchCoarseHeight(local);
+    }
+    vec2 fromCamera = abs(worldXZ - cameraPos.xz) / levelSpacing;
+    float halfSize = float(gridSize - 1) * 0.5;
+    float alpha = clamp((max(fromCamera.x, fromCamera.y) - (halfSize - blendWidth - 2.0)) / blendWidth, 0.0, 1.0);
+    height = mix(height, coarseHeight, alpha);
+
+    float dx = fetchHeight(local + ivec2(1, 0)) - fetchHeight(local - ivec2(1, 0));
+    float dz = fetchHeight(local + ivec2(0, 1)) - fetchHeight(local - ivec2(0, 1));
+    vec3 vertexNormal = normalize(vec3(-dx, 2.0 * levelSpacing, -dz));
+    vec3 vertexTangent = normalize(vec3(2.0 * levelSpacing, dx, 0.0));
+    vec3 position = vec3(worldXZ.x, height, worldXZ.y);
+    vec2 texCoords = worldXZ * texScale;
+
+    TexCoords = texCoords;
+
+    float displacement = texture(dispMap, texCoords).r * 0.04;
+    vec3 displacedPos = position + vertexNormal * displacement;
+
+    vec3 bitangent = normalize(cross(vertexNormal, vertexTangent));
+    TBN = mat3(vertexTangent, bitangent, vertexNormal);
+
+    FragPos = vec3(model * vec4(displacedPos, 1.0));
+    Normal = normalize(mat3(transpose(inverse(model))) * vertexNormal);
+
+    gl_Position = projection * view * model * vec4(displacedPos, 1.0);
+}
@@ -3,6 +3,11 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec3 aTangent;
 layout (location = 3) in vec2 aTexCoords;
+// Compact vertices only carry a normalized height and an octahedral normal
+layout (location = 4) in float aHeight;
+layout (location = 5) in vec2 aOctNormal;
+// Height this vertex collapses onto when its CDLOD node morphs into the next coarser level
+layout (location = 6) in float aMorphHeight;
 
 out vec3 FragPos;
 out vec3 Normal;
@@ -14,20 +19,104 @@ uniform mat4 view;
 uniform mat4 projection;
 uniform sampler2D dispMap;
 
+uniform bool compactVertices;
+uniform vec2 chunkOrigin;
+uniform float gridSpacing;
+uniform int gridWidth;
+uniform int gridDepth;
+uniform float texScale;
+uniform vec2 heightRange; // min height, max - min
+uniform int lodStep; // grid step of the CDLOD node, 0 when it does not morph
+uniform vec2 morphRange; // distances where morphing starts and ends
+uniform vec3 cameraPos;
+// Heights of the chunk with a one-texel border, normalized like aHeight
+uniform bool heightTexture;
+uniform sampler2DArray heightTextures;
+uniform int heightLayer;
+
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    if (n.y < 0.0) {
+        vec2 signs = mix(vec2(-1.0), vec2(1.0), greaterThanEqual(n.xz, vec2(0.0)));
+        n.xz = (1.0 - abs(n.zx)) * signs;
+    }
+    return normalize(n);
+}
+
+// Grid position of a compact vertex. Skirt vertices of MipChain chunks follow the grid, one row
+// of gridWidth per edge in the order z = 0, z = gridDepth - 1, x = 0, x = gridWidth - 1.
+vec2 gridPosition(int vertex)
+{
+    int skirt = vertex - gridWidth * gridDepth;
+    if (skirt < 0) {
+        return vec2(vertex % gridWidth, vertex / gridWidth);
+    }
+    int edge = skirt / gridWidth;
+    float t = float(skirt % gridWidth);
+    if (edge == 0) {
+        return vec2(t, 0.0);
+    }
+    if (edge == 1) {
+        return vec2(t, float(gridDepth - 1));
+    }
+    return edge == 2 ? vec2(0.0, t) : vec2(float(gridWidth - 1), t);
+}
+
+float textureHeight(ivec2 texel)
+{
+    return heightRange.x + texelFetch(heightTextures, ivec3(texel, heightLayer), 0).r * heightRange.y;
+}
+
 void main()
 {
-    TexCoords = aTexCoords;
+    vec3 position = aPos;
+    vec3 vertexNormal = aNormal;
+    vec3 vertexTangent = aTangent;
+    vec2 texCoords = aTexCoords;
+    if (heightTexture) {
+        vec2 grid = gridPosition(gl_VertexID);
+        ivec2 texel = ivec2(grid) + 1;
+        float dx = textureHeight(texel + ivec2(1, 0)) - textureHeight(texel - ivec2(1, 0));
+        float dz = textureHeight(texel + ivec2(0, 1)) - textureHeight(texel - ivec2(0, 1));
+        position = vec3(chunkOrigin.x + grid.x * gridSpacing, textureHeight(texel), chunkOrigin.y + grid.y * gridSpacing);
+        // Central differences over the one-texel border, so chunk edges see their neighbours
+        vertexNormal = normalize(vec3(-dx, 2.0 * gridSpacing, -dz));
+        vertexTangent = vec3(vertexNormal.y, -vertexNormal.x, 0.0);
+        texCoords = vec2(grid.x / gridWidth, grid.y / gridDepth) * texScale;
+    } else if (compactVertices) {
+        vec2 grid = gridPosition(gl_VertexID);
+        float height = heightRange.x + aHeight * heightRange.y;
+        if (lodStep > 0) {
+            // Vertices that are not on the next coarser grid slide onto their neighbour towards
+            // the chunk corner as the camera moves away, so the node meets its parent level
+            vec2 odd = mod(grid / float(lodStep), 2.0);
+            vec3 unmorphed = vec3(chunkOrigin.x + grid.x * gridSpacing, height, chunkOrigin.y + grid.y * gridSpacing);
+            float k = clamp((distance(unmorphed, cameraPos) - morphRange.x) / (morphRange.y - morphRange.x), 0.0, 1.0);
+            if (odd.x + odd.y > 0.0) {
+                grid -= odd * float(lodStep) * k;
+                height = mix(height, heightRange.x + aMorphHeight * heightRange.y, k);
+            }
+        }
+        position = vec3(chunkOrigin.x + grid.x * gridSpacing, height, chunkOrigin.y + grid.y * gridSpacing);
+        vertexNormal = octDecode(aOctNormal);
+        // On a heightfield the tangent along +X follows from the normal
+        vertexTangent = vec3(vertexNormal.y, -vertexNormal.x, 0.0);
+        texCoords = vec2(grid.x / gridWidth, grid.y / gridDepth) * texScale;
+    }
+
+    TexCoords = texCoords;
 
-    float displacement = texture(dispMap, aTexCoords).r * 0.04;
-    vec3 displacedPos = aPos + aNormal * displacement;
+    float displacement = texture(dispMap, texCoords).r * 0.04;
+    vec3 displacedPos = position + vertexNormal * displacement;
 
-    vec3 bitangent = normalize(cross(aNormal, aTangent));
-    vec3 tangent = normalize(aTangent);
-    vec3 normal = normalize(aNormal);
+    vec3 bitangent = normalize(cross(vertexNormal, vertexTangent));
+    vec3 tangent = normalize(vertexTangent);
+    vec3 normal = normalize(vertexNormal);
     TBN = mat3(tangent, bitangent, normal);
 
     FragPos = vec3(model * vec4(displacedPos, 1.0)); // Use displacedPos here
-    Normal = normalize(mat3(transpose(inverse(model))) * aNormal);
+    Normal = normalize(mat3(transpose(inverse(model))) * vertexNormal);
 
     gl_Position = projection * view * model * vec4(displacedPos, 1.0);
-}
\ No newline at end of file
+}
@@ -0,0 +1,113 @@
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : require
+// Same as terrain.vs, but every chunk of a batch is drawn by one glMultiDrawElementsIndirect,
+// so the per-chunk uniforms come from an SSBO indexed by the draw ID instead
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec3 aTangent;
+layout (location = 3) in vec2 aTexCoords;
+layout (location = 4) in float aHeight;
+layout (location = 5) in vec2 aOctNormal;
+// Height this vertex collapses onto when its CDLOD node morphs into the next coarser level
+layout (location = 6) in float aMorphHeight;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+out mat3 TBN;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform sampler2D dispMap;
+
+uniform bool compactVertices;
+uniform float gridSpacing;
+uniform int gridWidth;
+uniform int gridDepth;
+uniform float texScale;
+uniform vec3 cameraPos;
+
+struct ChunkDrawData {
+    vec2 chunkOrigin;
+    vec2 heightRange; // min height, max - min
+    vec2 morphRange; // distances where morphing starts and ends
+    int lodStep; // grid step of the CDLOD node, 0 when it does not morph
+    int slotBase; // first vertex of the chunk in the shared vertex buffer
+};
+
+layout (std430, binding = 0) readonly buffer ChunkDraws {
+    ChunkDrawData chunkDraws[];
+};
+
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    if (n.y < 0.0) {
+        vec2 signs = mix(vec2(-1.0), vec2(1.0), greaterThanEqual(n.xz, vec2(0.0)));
+        n.xz = (1.0 - abs(n.zx)) * signs;
+    }
+    return normalize(n);
+}
+
+// Skirt vertices are laid out as described in terrain.vs
+vec2 gridPosition(int vertex)
+{
+    int skirt = vertex - gridWidth * gridDepth;
+    if (skirt < 0) {
+        return vec2(vertex % gridWidth, vertex / gridWidth);
+    }
+    int edge = skirt / gridWidth;
+    float t = float(skirt % gridWidth);
+    if (edge == 0) {
+        return vec2(t, 0.0);
+    }
+    if (edge == 1) {
+        return vec2(t, float(gridDepth - 1));
+    }
+    return edge == 2 ? vec2(0.0, t) : vec2(float(gridWidth - 1), t);
+}
+
+void main()
+{
+    vec3 position = aPos;
+    vec3 vertexNormal = aNormal;
+    vec3 vertexTangent = aTangent;
+    vec2 texCoords = aTexCoords;
+    if (compactVertices) {
+        ChunkDrawData chunk = chunkDraws[gl_DrawIDARB];
+        // gl_VertexID includes the BaseVertex that selects the chunk's slot in the shared buffer
+        int vertex = gl_VertexID - chunk.slotBase;
+        vec2 grid = gridPosition(vertex);
+        float height = chunk.heightRange.x + aHeight * chunk.heightRange.y;
+        if (chunk.lodStep > 0) {
+            vec2 odd = mod(grid / float(chunk.lodStep), 2.0);
+            vec3 unmorphed = vec3(chunk.chunkOrigin.x + grid.x * gridSpacing, height, chunk.chunkOrigin.y + grid.y * gridSpacing);
+            float k = clamp((distance(unmorphed, cameraPos) - chunk.morphRange.x) / (chunk.morphRange.y - chunk.morphRange.x), 0.0, 1.0);
+            if (odd.x + odd.y > 0.0) {
+                grid -= odd * float(chunk.lodStep) * k;
+                height = mix(height, chunk.heightRange.x + aMorphHeight * chunk.heightRange.y, k);
+            }
+        }
+        position = vec3(chunk.chunkOrigin.x + grid.x * gridSpacing, height, chunk.chunkOrigin.y + grid.y * gridSpacing);
+        vertexNormal = octDecode(aOctNormal);
+        // On a heightfield the tangent along +X follows from the normal
+        vertexTangent = vec3(vertexNormal.y, -vertexNormal.x, 0.0);
+        texCoords = vec2(grid.x / gridWidth, grid.y / gridDepth) * texScale;
+    }
+
+    TexCoords = texCoords;
+
+    float displacement = texture(dispMap, texCoords).r * 0.04;
+    vec3 displacedPos = position + vertexNormal * displacement;
+
+    vec3 bitangent = normalize(cross(vertexNormal, vertexTangent));
+    vec3 tangent = normalize(vertexTangent);
+    vec3 normal = normalize(vertexNormal);
+    TBN = mat3(tangent, bitangent, normal);
+
+    FragPos = vec3(model * vec4(displacedPos, 1.0));
+    Normal = normalize(mat3(transpose(inverse(model))) * vertexNormal);
+
+    gl_Position = projection * view * model * vec4(displacedPos, 1.0);
+}
@@ -0,0 +1,59 @@
+//
+// Created by Lucas Wang on 2024-08-26.
+//
+
+#include "ChunkBufferPool.h"
+#include <algorithm>
+
+std::map<ChunkBufferPool::Key, std::vector<ChunkBufferSlot>> ChunkBufferPool::s_free;
+ChunkBufferPoolStats ChunkBufferPool::s_stats;
+
+ChunkBufferSlot ChunkBufferPool::Acquire(VertexFormat format, int width, int depth, IndexTopology topology) {
+    ChunkBufferSlot slot;
+    auto& free = s_free[std::make_tuple(format, width, depth, topology)];
+    if (!free.empty()) {
+        slot = free.back();
+        free.pop_back();
+        --s_stats.Free;
+    } else {
+        glGenVertexArrays(1, &slot.VAO);
+        // Height texture chunks draw without vertex attributes
+        if (format != VertexFormat::HeightTexture) {
+            glGenBuffers(1, &slot.VBO);
+        }
+        if (topology == IndexTopology::Adaptive) {
+            glGenBuffers(1, &slot.EBO);
+        }
+        ++s_stats.Created;
+    }
+
+    ++s_stats.InUse;
+    s_stats.HighWater = std::max(s_stats.HighWater, s_stats.InUse);
+    return slot;
+}
+
+void ChunkBufferPool::Release(VertexFormat format, int width, int depth, IndexTopology topology, const ChunkBufferSlot& slot) {
+    s_free[std::make_tuple(format, width, depth, topology)].push_back(slot);
+    --s_stats.InUse;
+    ++s_stats.Free;
+}
+
+void ChunkBufferPool::Clear() {
+    for (auto& [key, free] : s_free) {
+        for (const ChunkBufferSlot& slot : free) {
+            glDeleteVertexArrays(1, &slot.VAO);
+            if (slot.VBO != 0) {
+                glDeleteBuffers(1, &slot.VBO);
+            }
+            if (slot.EBO != 0) {
+                glDeleteBuffers(1, &slot.EBO);
+            }
+        }
+    }
+    s_free.clear();
+    s_stats.Free = 0;
+}
+
+ChunkBufferPoolStats ChunkBufferPool::GetStats() {
+    return s_stats;
+}
@@ -0,0 +1,53 @@
+//
+// Created by Lucas Wang on 2024-08-26.
+//
+
+#ifndef TERRAINRENDERING_CHUNKBUFFERPOOL_H
+#define TERRAINRENDERING_CHUNKBUFFERPOOL_H
+
+#include "glad/glad.h"
+#include <cstddef>
+#include <map>
+#include <tuple>
+#include <vector>
+#include "terrain.h"
+
+struct ChunkBufferSlot {
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+    // 0 for freshly generated names; the VAO is then still unconfigured and the VBO unallocated
+    GLsizeiptr Size = 0;
+    // IndexTopology::Adaptive only: the chunk's own index buffer, bound to the VAO
+    GLuint EBO = 0;
+    // Bytes allocated in EBO, the most any previous owner needed since RTIN meshes vary in size
+    GLsizeiptr EBOSize = 0;
+};
+
+struct ChunkBufferPoolStats {
+    std::size_t InUse = 0;
+    std::size_t Free = 0;
+    std::size_t HighWater = 0;
+    // Slots ever generated, flat once the pool has warmed up
+    std::size_t Created = 0;
+};
+
+// Evicted chunks hand their VAO/VBO back here instead of deleting them, and new chunks of the
+// same size and layout take them over, so streaming chunks in and out does not allocate in the
+// driver once the pool holds enough slots. Must only be used on the GL thread.
+class ChunkBufferPool {
+public:
+    static ChunkBufferSlot Acquire(VertexFormat format, int width, int depth, IndexTopology topology);
+    static void Release(VertexFormat format, int width, int depth, IndexTopology topology, const ChunkBufferSlot& slot);
+    // Deletes the GL names of every free slot
+    static void Clear();
+    static ChunkBufferPoolStats GetStats();
+
+private:
+    using Key = std::tuple<VertexFormat, int, int, IndexTopology>;
+
+    static std::map<Key, std::vector<ChunkBufferSlot>> s_free;
+    static ChunkBufferPoolStats s_stats;
+};
+
+
+#endif //TERRAINRENDERING_CHUNKBUFFERPOOL_H
@@ -0,0 +1,173 @@
+//
+// Created by Lucas Wang on 2024-08-28.
+//
+
+#include "ChunkDrawBatch.h"
+#include <algorithm>
+#include "GLExtensions.h"
+
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect,
+                                                            GLsizei drawcount, GLsizei stride);
+static PFNGLMULTIDRAWELEMENTSINDIRECTPROC s_multiDrawElementsIndirect = nullptr;
+static bool s_supported = false;
+
+static const int kInitialSlots = 16;
+
+bool ChunkDrawBatch::LoadFunctions(GLADloadproc load) {
+    s_supported = false;
+    if (!GLExtensions::HasVersion(4, 3) || !GLExtensions::HasExtension("GL_ARB_shader_draw_parameters")) {
+        return false;
+    }
+
+    s_multiDrawElementsIndirect = reinterpret_cast<PFNGLMULTIDRAWELEMENTSINDIRECTPROC>(load("glMultiDrawElementsIndirect"));
+    s_supported = s_multiDrawElementsIndirect != nullptr;
+    return s_supported;
+}
+
+bool ChunkDrawBatch::IsSupported() {
+    return s_supported;
+}
+
+ChunkDrawBatch::ChunkDrawBatch(VertexFormat format, int width, int depth, IndexTopology topology, float terrainScale) :
+    m_format(format),
+    m_width(width),
+    m_depth(depth),
+    m_topology(topology),
+    m_terrainScale(terrainScale),
+    m_indexBuffer(&IndexBufferRegistry::GetBuffer(width, depth, topology)) {
+    GLsizeiptr stride = format == VertexFormat::Compact ? sizeof(Terrain::CompactVertex) : sizeof(Terrain::Vertex);
+    m_slotVertices = IndexBufferRegistry::GetVertexCount(width, depth, topology);
+    m_slotSize = stride * m_slotVertices;
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_indirectBuffer);
+    glGenBuffers(1, &m_drawDataBuffer);
+    Grow(kInitialSlots);
+}
+
+ChunkDrawBatch::~ChunkDrawBatch() {
+    glDeleteVertexArrays(1, &m_VAO);
+    glDeleteBuffers(1, &m_VBO);
+    glDeleteBuffers(1, &m_indirectBuffer);
+    glDeleteBuffers(1, &m_drawDataBuffer);
+}
+
+bool ChunkDrawBatch::Matches(VertexFormat format, int width, int depth, IndexTopology topology) const {
+    return m_format == format && m_width == width && m_depth == depth && m_topology == topology;
+}
+
+void ChunkDrawBatch::Grow(int capacity) {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, m_slotSize * capacity, nullptr, GL_STATIC_DRAW);
+    if (m_VBO != 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, m_VBO);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, m_slotSize * m_capacity);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &m_VBO);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    m_VBO = buffer;
+
+    glBindVertexArray(m_VAO);
+    Terrain::SetupVertexFormat(m_format, m_VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer->EBO);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Handed out lowest first, which keeps the used part of the buffer compact
+    for (int slot = capacity - 1; slot >= m_capacity; --slot) {
+        m_freeSlots.push_back(slot);
+    }
+    m_capacity = capacity;
+}
+
+int ChunkDrawBatch::Allocate() {
+    if (m_freeSlots.empty()) {
+        Grow(m_capacity * 2);
+    }
+    int slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    return slot;
+}
+
+void ChunkDrawBatch::Free(int slot) {
+    m_freeSlots.push_back(slot);
+}
+
+void ChunkDrawBatch::Upload(int slot, const void* data, GLsizeiptr size) {
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, m_slotSize * slot, std::min(size, m_slotSize), data);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ChunkDrawBatch::Copy(int slot, GLuint source, GLintptr sourceOffset, GLsizeiptr size) {
+    glBindBuffer(GL_COPY_READ_BUFFER, source);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_VBO);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, m_slotSize * slot, std::min(size, m_slotSize));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void ChunkDrawBatch::Add(int slot, const ChunkDrawData& data) {
+    IndexRange range;
+    range.Count = m_indexBuffer->Count;
+    Add(slot, data, range, 0);
+}
+
+void ChunkDrawBatch::Add(int slot, const ChunkDrawData& data, const IndexRange& range, GLint vertexOffset) {
+    DrawElementsIndirectCommand command{};
+    command.Count = static_cast<GLuint>(range.Count);
+    command.InstanceCount = 1;
+    command.FirstIndex = range.First;
+    command.BaseVertex = slot * m_slotVertices + vertexOffset;
+    m_commands.push_back(command);
+    m_drawData.push_back(data);
+    m_drawData.back().SlotBase = slot * m_slotVertices;
+}
+
+void ChunkDrawBatch::Draw(Shader& shader) {
+    m_lastDrawCount = m_commands.size();
+    if (m_commands.empty()) {
+        return;
+    }
+
+    shader.use();
+    shader.setBool("compactVertices", m_format == VertexFormat::Compact);
+    shader.setFloat("gridSpacing", 1.0f / m_terrainScale);
+    shader.setInt("gridWidth", m_width);
+    shader.setInt("gridDepth", m_depth);
+    shader.setFloat("texScale", Terrain::kTexScale);
+
+    // Both buffers are respecified every frame so the driver can hand out fresh storage
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * m_commands.size(), m_commands.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawDataBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(ChunkDrawData) * m_drawData.size(), m_drawData.data(), GL_STREAM_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_drawDataBuffer);
+
+    glBindVertexArray(m_VAO);
+    if (m_indexBuffer->PrimitiveRestart) {
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(m_indexBuffer->RestartIndex);
+    }
+    s_multiDrawElementsIndirect(m_indexBuffer->Mode, m_indexBuffer->Type, nullptr, static_cast<GLsizei>(m_commands.size()), 0);
+    if (m_indexBuffer->PrimitiveRestart) {
+        glDisable(GL_PRIMITIVE_RESTART);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    m_commands.clear();
+    m_drawData.clear();
+}
+
+std::size_t ChunkDrawBatch::GetSlotCount() const {
+    return static_cast<std::size_t>(m_capacity) - m_freeSlots.size();
+}
+
+std::size_t ChunkDrawBatch::GetDrawCount() const {
+    return m_lastDrawCount;
+}
@@ -0,0 +1,97 @@
+//
+// Created by Lucas Wang on 2024-08-28.
+//
+
+#ifndef TERRAINRENDERING_CHUNKDRAWBATCH_H
+#define TERRAINRENDERING_CHUNKDRAWBATCH_H
+
+#include "glad/glad.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+#include "terrain.h"
+#include "shader.h"
+
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+
+struct DrawElementsIndirectCommand {
+    GLuint Count;
+    GLuint InstanceCount;
+    GLuint FirstIndex;
+    GLint BaseVertex;
+    GLuint BaseInstance;
+};
+
+// Per-draw data read by terrain_indirect.vs through gl_DrawID, laid out to match std430
+struct ChunkDrawData {
+    glm::vec2 ChunkOrigin;
+    // min height, max - min
+    glm::vec2 HeightRange;
+    glm::vec2 MorphRange;
+    // Grid step of the CDLOD node being drawn, 0 when it does not morph
+    GLint LodStep;
+    // First vertex of the chunk's slot, filled in by ChunkDrawBatch::Add
+    GLint SlotBase;
+};
+
+// All chunks of one layout (vertex format, grid size, index topology) share one large vertex
+// buffer, one VAO and the shared index buffer. Each chunk owns a fixed-size slot of the vertex
+// buffer, and the visible chunks are drawn with a single glMultiDrawElementsIndirect whose
+// commands point at their slots through BaseVertex. Must only be used on the GL thread.
+class ChunkDrawBatch {
+public:
+    // Multi-draw-indirect needs GL 4.3 for the entry point and SSBOs plus ARB_shader_draw_parameters
+    // for gl_DrawID. Call once after gladLoadGLLoader(); without them chunks are drawn one by one.
+    static bool LoadFunctions(GLADloadproc load);
+    static bool IsSupported();
+
+    ChunkDrawBatch(VertexFormat format, int width, int depth, IndexTopology topology, float terrainScale);
+    ~ChunkDrawBatch();
+    ChunkDrawBatch(const ChunkDrawBatch&) = delete;
+    ChunkDrawBatch& operator=(const ChunkDrawBatch&) = delete;
+
+    bool Matches(VertexFormat format, int width, int depth, IndexTopology topology) const;
+
+    // Grows the vertex buffer when every slot is taken
+    int Allocate();
+    void Free(int slot);
+    void Upload(int slot, const void* data, GLsizeiptr size);
+    // GPU-side copy into the slot, e.g. out of the staging ring
+    void Copy(int slot, GLuint source, GLintptr sourceOffset, GLsizeiptr size);
+
+    // Collects the chunks to draw this frame, then submits them all in one call
+    void Add(int slot, const ChunkDrawData& data);
+    // Draws only the given indices, offset by vertexOffset within the slot
+    void Add(int slot, const ChunkDrawData& data, const IndexRange& range, GLint vertexOffset);
+    void Draw(Shader& shader);
+
+    std::size_t GetSlotCount() const;
+    std::size_t GetDrawCount() const;
+
+private:
+    VertexFormat m_format;
+    int m_width;
+    int m_depth;
+    IndexTopology m_topology;
+    float m_terrainScale;
+    const SharedIndexBuffer* m_indexBuffer;
+    int m_slotVertices;
+    GLsizeiptr m_slotSize;
+
+    GLuint m_VAO = 0;
+    GLuint m_VBO = 0;
+    GLuint m_indirectBuffer = 0;
+    GLuint m_drawDataBuffer = 0;
+    int m_capacity = 0;
+    std::vector<int> m_freeSlots;
+    std::vector<DrawElementsIndirectCommand> m_commands;
+    std::vector<ChunkDrawData> m_drawData;
+    std::size_t m_lastDrawCount = 0;
+
+    void Grow(int capacity);
+};
+
+
+#endif //TERRAINRENDERING_CHUNKDRAWBATCH_H
@@ -0,0 +1,60 @@
+//
+// Created by Lucas Wang on 2024-08-20.
+//
+
+#include "ChunkGrid.h"
+
+ChunkGrid::ChunkGrid(int sizeX, int sizeZ)
+        : m_sizeX(sizeX), m_sizeZ(sizeZ), m_slots(static_cast<size_t>(sizeX) * sizeZ) {
+
+}
+
+int ChunkGrid::SlotIndex(int x, int z) const {
+    // Wrap negative coordinates into [0, size) as well
+    int slotX = ((x % m_sizeX) + m_sizeX) % m_sizeX;
+    int slotZ = ((z % m_sizeZ) + m_sizeZ) % m_sizeZ;
+    return slotZ * m_sizeX + slotX;
+}
+
+Terrain* ChunkGrid::Find(int x, int z) const {
+    const Slot& slot = m_slots[SlotIndex(x, z)];
+    if (slot.Chunk && slot.X == x && slot.Z == z) {
+        return slot.Chunk;
+    }
+    return nullptr;
+}
+
+Terrain* ChunkGrid::Insert(int x, int z, Terrain* chunk) {
+    Slot& slot = m_slots[SlotIndex(x, z)];
+    Terrain* previous = slot.Chunk;
+    slot.X = x;
+    slot.Z = z;
+    slot.Chunk = chunk;
+    return previous;
+}
+
+Terrain* ChunkGrid::Remove(int x, int z) {
+    Slot& slot = m_slots[SlotIndex(x, z)];
+    if (!slot.Chunk || slot.X != x || slot.Z != z) {
+        return nullptr;
+    }
+    Terrain* chunk = slot.Chunk;
+    slot.Chunk = nullptr;
+    return chunk;
+}
+
+std::vector<ChunkGrid::Slot>& ChunkGrid::GetSlots() {
+    return m_slots;
+}
+
+const std::vector<ChunkGrid::Slot>& ChunkGrid::GetSlots() const {
+    return m_slots;
+}
+
+int ChunkGrid::GetSizeX() const {
+    return m_sizeX;
+}
+
+int ChunkGrid::GetSizeZ() const {
+    return m_sizeZ;
+}
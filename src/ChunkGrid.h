@@ -0,0 +1,45 @@
+//
+// Created by Lucas Wang on 2024-08-20.
+//
+
+#ifndef TERRAINRENDERING_CHUNKGRID_H
+#define TERRAINRENDERING_CHUNKGRID_H
+
+#include <vector>
+#include "terrain.h"
+
+// Fixed-capacity toroidal grid of chunks: chunk (x, z) always lives in slot (x mod sizeX, z mod sizeZ).
+// As long as the loaded window is no larger than the grid, every chunk in it has its own slot,
+// lookups are a single index computation and a chunk that scrolls out frees exactly the slot
+// the chunk scrolling in needs.
+class ChunkGrid {
+public:
+    struct Slot {
+        int X = 0;
+        int Z = 0;
+        Terrain* Chunk = nullptr;
+    };
+
+    ChunkGrid(int sizeX, int sizeZ);
+
+    Terrain* Find(int x, int z) const;
+    // Returns the chunk that previously occupied the slot, if any, so the caller can release it
+    Terrain* Insert(int x, int z, Terrain* chunk);
+    Terrain* Remove(int x, int z);
+
+    // Slots are stored contiguously; empty ones have a null Chunk
+    std::vector<Slot>& GetSlots();
+    const std::vector<Slot>& GetSlots() const;
+    int GetSizeX() const;
+    int GetSizeZ() const;
+
+private:
+    int m_sizeX;
+    int m_sizeZ;
+    std::vector<Slot> m_slots;
+
+    int SlotIndex(int x, int z) const;
+};
+
+
+#endif //TERRAINRENDERING_CHUNKGRID_H
@@ -0,0 +1,69 @@
+//
+// Created by Lucas Wang on 2024-09-20.
+//
+
+#include "ChunkHeightTextures.h"
+
+ChunkHeightTextures::ChunkHeightTextures(int chunkSize) :
+    m_textureSize(chunkSize + 2) {
+}
+
+ChunkHeightTextures::~ChunkHeightTextures() {
+    if (!m_pages.empty()) {
+        glDeleteTextures(static_cast<GLsizei>(m_pages.size()), m_pages.data());
+    }
+}
+
+void ChunkHeightTextures::addPage() {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R16, m_textureSize, m_textureSize, kLayersPerPage, 0, GL_RED,
+                 GL_UNSIGNED_SHORT, nullptr);
+    // Only read with texelFetch, but an incomplete mip chain would still make the texture invalid
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    int page = static_cast<int>(m_pages.size());
+    m_pages.push_back(texture);
+    // Handed out from the back, so the first layer goes first
+    for (int index = kLayersPerPage - 1; index >= 0; --index) {
+        m_freeLayers.push_back(Layer{ page, index });
+    }
+}
+
+ChunkHeightTextures::Layer ChunkHeightTextures::Allocate() {
+    if (m_freeLayers.empty()) {
+        addPage();
+    }
+    Layer layer = m_freeLayers.back();
+    m_freeLayers.pop_back();
+    return layer;
+}
+
+void ChunkHeightTextures::Free(const Layer& layer) {
+    m_freeLayers.push_back(layer);
+}
+
+void ChunkHeightTextures::Upload(const Layer& layer, const std::uint16_t* texels) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_pages[layer.Page]);
+    // Rows of an odd texel count are not 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer.Index, m_textureSize, m_textureSize, 1, GL_RED,
+                    GL_UNSIGNED_SHORT, texels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+GLuint ChunkHeightTextures::GetTexture(const Layer& layer) const {
+    return m_pages[layer.Page];
+}
+
+int ChunkHeightTextures::GetTextureSize() const {
+    return m_textureSize;
+}
+
+std::size_t ChunkHeightTextures::GetLayerBytes() const {
+    return sizeof(std::uint16_t) * m_textureSize * m_textureSize;
+}
@@ -0,0 +1,50 @@
+//
+// Created by Lucas Wang on 2024-09-20.
+//
+
+#ifndef TERRAINRENDERING_CHUNKHEIGHTTEXTURES_H
+#define TERRAINRENDERING_CHUNKHEIGHTTEXTURES_H
+
+#include "glad/glad.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Heights of the chunks drawn with VertexFormat::HeightTexture. Each chunk owns one layer of a
+// 2D array texture: (chunkSize + 2)^2 normalized 16-bit texels, its heights plus a one-sample
+// border so terrain.vs can take central differences at the chunk edges. Arrays cannot grow in
+// place, so layers come in pages of kLayersPerPage and a new page is added when all are taken.
+// Must only be used on the GL thread.
+class ChunkHeightTextures {
+public:
+    static constexpr int kLayersPerPage = 16;
+
+    struct Layer {
+        int Page = -1;
+        int Index = 0;
+    };
+
+    explicit ChunkHeightTextures(int chunkSize);
+    ~ChunkHeightTextures();
+    ChunkHeightTextures(const ChunkHeightTextures&) = delete;
+    ChunkHeightTextures& operator=(const ChunkHeightTextures&) = delete;
+
+    Layer Allocate();
+    void Free(const Layer& layer);
+    // texels holds GetTextureSize()^2 values, row by row
+    void Upload(const Layer& layer, const std::uint16_t* texels);
+    GLuint GetTexture(const Layer& layer) const;
+
+    int GetTextureSize() const;
+    std::size_t GetLayerBytes() const;
+
+private:
+    int m_textureSize;
+    std::vector<GLuint> m_pages;
+    std::vector<Layer> m_freeLayers;
+
+    void addPage();
+};
+
+
+#endif //TERRAINRENDERING_CHUNKHEIGHTTEXTURES_H
@@ -0,0 +1,37 @@
+//
+// Created by Lucas Wang on 2024-09-02.
+//
+
+#ifndef TERRAINRENDERING_CHUNKLODLEVELS_H
+#define TERRAINRENDERING_CHUNKLODLEVELS_H
+
+// CDLOD level layout shared by the LodNodes index buffers and ChunkLodQuadtree. Plain
+// arithmetic, so the quadtree does not need the GL side of IndexBufferRegistry.
+
+// Quads along each side of a CDLOD node mesh; a node at level l spans kLodNodeQuads << l quads
+const int kLodNodeQuads = 32;
+// CDLOD levels above the one whose node is a whole chunk. A node there spans 2^n x 2^n chunks,
+// and each chunk draws its own part of it, kLodNodeQuads >> n quads a side.
+const int kLodBlockLevels = 5;
+static_assert((kLodNodeQuads >> kLodBlockLevels) == 1, "the coarsest block level draws one quad per chunk");
+
+// Number of CDLOD levels including the kLodBlockLevels block levels, or 0 when the grid is not
+// square with (width - 1) equal to kLodNodeQuads times a power of two
+inline int GetLodLevelCount(int width, int depth) {
+    int quads = width - 1;
+    if (width != depth || quads < kLodNodeQuads || quads % kLodNodeQuads != 0) {
+        return 0;
+    }
+    int nodes = quads / kLodNodeQuads;
+    if ((nodes & (nodes - 1)) != 0) {
+        return 0;
+    }
+    int levels = 1;
+    while ((kLodNodeQuads << (levels - 1)) < quads) {
+        ++levels;
+    }
+    return levels + kLodBlockLevels;
+}
+
+
+#endif //TERRAINRENDERING_CHUNKLODLEVELS_H
@@ -0,0 +1,125 @@
+//
+// Created by Lucas Wang on 2024-09-02.
+//
+
+#include "ChunkLodQuadtree.h"
+#include <algorithm>
+#include <limits>
+
+// Fraction of the way from the previous range to a level's own range at which morphing starts
+static const float kMorphStartRatio = 0.7f;
+
+static bool IntersectsSphere(const AABB& box, const glm::vec3& center, float radius) {
+    glm::vec3 closest = glm::clamp(center, box.Min, box.Max);
+    glm::vec3 offset = closest - center;
+    return glm::dot(offset, offset) <= radius * radius;
+}
+
+ChunkLodQuadtree::ChunkLodQuadtree(int chunkSize, float terrainScale, float leafRange) :
+    m_quads(chunkSize - 1),
+    m_levelCount(GetLodLevelCount(chunkSize, chunkSize)),
+    m_chunkLevel(m_levelCount - 1 - kLodBlockLevels),
+    m_chunkExtent((chunkSize - 1) / terrainScale) {
+    for (int level = 0; level < m_levelCount; ++level) {
+        m_ranges.push_back(leafRange * static_cast<float>(1 << level));
+    }
+}
+
+int ChunkLodQuadtree::GetLevelCount() const {
+    return m_levelCount;
+}
+
+int ChunkLodQuadtree::GetChunkLevel() const {
+    return m_chunkLevel;
+}
+
+float ChunkLodQuadtree::GetRange(int level) const {
+    return m_ranges[level];
+}
+
+glm::vec2 ChunkLodQuadtree::GetMorphRange(int level) const {
+    float previous = level > 0 ? m_ranges[level - 1] : 0.0f;
+    float end = m_ranges[level];
+    return glm::vec2(previous + (end - previous) * kMorphStartRatio, end);
+}
+
+void ChunkLodQuadtree::Select(int chunkX, int chunkZ, const AABB& chunkBounds, const glm::vec3& cameraPosition,
+                              const Frustum& frustum, std::vector<LodNode>& nodes) const {
+    if (m_levelCount == 0) {
+        return;
+    }
+
+    // Walk down the block nodes holding the chunk, from the top one, which covers everything
+    // left. A block stops the walk, and the chunk draws its part of it, when the block does not
+    // reach the next level's range or the child holding the chunk is outside its own range.
+    for (int level = m_levelCount - 1; level > m_chunkLevel; --level) {
+        bool split = IntersectsSphere(blockBounds(chunkX, chunkZ, level), cameraPosition, m_ranges[level - 1]);
+        if (split && level - 1 > m_chunkLevel) {
+            split = IntersectsSphere(blockBounds(chunkX, chunkZ, level - 1), cameraPosition, m_ranges[level - 1]);
+        }
+        if (!split) {
+            nodes.push_back(LodNode{ 0, 0, level, -1 });
+            return;
+        }
+    }
+    if (!selectNode(0, 0, m_chunkLevel, chunkBounds, cameraPosition, frustum, nodes)) {
+        nodes.push_back(LodNode{ 0, 0, m_chunkLevel + 1, -1 });
+    }
+}
+
+std::size_t ChunkLodQuadtree::GetTriangleCount(const LodNode& node) const {
+    std::size_t quads = node.Level > m_chunkLevel ? kLodNodeQuads >> (node.Level - m_chunkLevel) : kLodNodeQuads;
+    std::size_t triangles = quads * quads * 2;
+    return node.Quadrant < 0 ? triangles : triangles / 4;
+}
+
+bool ChunkLodQuadtree::selectNode(int x, int z, int level, const AABB& chunkBounds, const glm::vec3& cameraPosition,
+                                  const Frustum& frustum, std::vector<LodNode>& nodes) const {
+    const int size = kLodNodeQuads << level;
+    AABB bounds = nodeBounds(x, z, size, chunkBounds);
+
+    // Out of this level's range, so the parent covers it
+    if (!IntersectsSphere(bounds, cameraPosition, m_ranges[level])) {
+        return false;
+    }
+    if (!frustum.Intersects(bounds)) {
+        return true;
+    }
+    if (level == 0 || !IntersectsSphere(bounds, cameraPosition, m_ranges[level - 1])) {
+        nodes.push_back(LodNode{ x, z, level, -1 });
+        return true;
+    }
+
+    const int half = size / 2;
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        int childX = x + (quadrant % 2) * half;
+        int childZ = z + (quadrant / 2) * half;
+        if (!selectNode(childX, childZ, level - 1, chunkBounds, cameraPosition, frustum, nodes)) {
+            nodes.push_back(LodNode{ x, z, level, quadrant });
+        }
+    }
+    return true;
+}
+
+AABB ChunkLodQuadtree::nodeBounds(int x, int z, int size, const AABB& chunkBounds) const {
+    // Nodes share the height range of the whole chunk, which keeps the boxes conservative
+    glm::vec3 extent = chunkBounds.Max - chunkBounds.Min;
+    float scale = 1.0f / static_cast<float>(m_quads);
+    AABB bounds = chunkBounds;
+    bounds.Min.x = chunkBounds.Min.x + extent.x * x * scale;
+    bounds.Min.z = chunkBounds.Min.z + extent.z * z * scale;
+    bounds.Max.x = chunkBounds.Min.x + extent.x * (x + size) * scale;
+    bounds.Max.z = chunkBounds.Min.z + extent.z * (z + size) * scale;
+    return bounds;
+}
+
+AABB ChunkLodQuadtree::blockBounds(int chunkX, int chunkZ, int level) const {
+    // Blocks are aligned to multiples of their span, so the right shift floors negative chunks
+    // into the right block. They ignore height, so every chunk of a block chooses alike.
+    const int shift = level - m_chunkLevel;
+    const float extent = m_chunkExtent * static_cast<float>(1 << shift);
+    const float lowest = std::numeric_limits<float>::lowest();
+    const float highest = std::numeric_limits<float>::max();
+    glm::vec3 origin((chunkX >> shift) * extent, 0.0f, (chunkZ >> shift) * extent);
+    return AABB{ glm::vec3(origin.x, lowest, origin.z), glm::vec3(origin.x + extent, highest, origin.z + extent) };
+}
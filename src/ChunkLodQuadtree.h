@@ -0,0 +1,68 @@
+//
+// Created by Lucas Wang on 2024-09-02.
+//
+
+#ifndef TERRAINRENDERING_CHUNKLODQUADTREE_H
+#define TERRAINRENDERING_CHUNKLODQUADTREE_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+#include "Frustum.h"
+#include "ChunkLodLevels.h"
+
+// A selected piece of a chunk: a whole CDLOD node, one quadrant of it whose children were out of
+// range, or the chunk's part of a block node. Either way it is drawn from the shared LodNodes
+// mesh of its level.
+struct LodNode {
+    // Corner of the node in quads from the chunk corner, used as the base vertex
+    int X;
+    int Z;
+    int Level;
+    // -1 for the whole node, otherwise 0..3 as z * 2 + x
+    int Quadrant;
+};
+
+// Continuous distance-dependent LOD over the chunk grid. Each level down halves the node size
+// while every node keeps kLodNodeQuads quads a side. Below the chunk level nodes split a chunk;
+// above it, kLodBlockLevels levels of block nodes span 2^n x 2^n grid-aligned chunks, and each
+// chunk draws its own part of the block node covering it. Far chunks thus shrink to a few
+// triangles, and the triangle count follows the LOD ranges rather than the view radius until
+// the coarsest block level is reached. Pure CPU code, it does not need a GL context.
+class ChunkLodQuadtree {
+public:
+    // chunkSize must give a non-zero GetLodLevelCount(). Level 0 nodes are
+    // drawn up to leafRange world units from the camera, and each coarser level twice as far.
+    ChunkLodQuadtree(int chunkSize, float terrainScale, float leafRange);
+
+    int GetLevelCount() const;
+    // Level whose node is a whole chunk; the levels above it are block levels
+    int GetChunkLevel() const;
+    float GetRange(int level) const;
+    // Distances between which vertices of a level morph into the grid of the next level up.
+    // The top level has nowhere to morph to.
+    glm::vec2 GetMorphRange(int level) const;
+
+    // Appends the pieces of chunk (chunkX, chunkZ) to draw. Nodes inside the chunk are culled
+    // against the frustum; the chunk itself is expected to have passed that test already.
+    void Select(int chunkX, int chunkZ, const AABB& chunkBounds, const glm::vec3& cameraPosition,
+                const Frustum& frustum, std::vector<LodNode>& nodes) const;
+
+    std::size_t GetTriangleCount(const LodNode& node) const;
+
+private:
+    int m_quads;
+    int m_levelCount;
+    int m_chunkLevel;
+    // World units along a chunk side
+    float m_chunkExtent;
+    std::vector<float> m_ranges;
+
+    bool selectNode(int x, int z, int level, const AABB& chunkBounds, const glm::vec3& cameraPosition,
+                    const Frustum& frustum, std::vector<LodNode>& nodes) const;
+    AABB nodeBounds(int x, int z, int size, const AABB& chunkBounds) const;
+    AABB blockBounds(int chunkX, int chunkZ, int level) const;
+};
+
+
+#endif //TERRAINRENDERING_CHUNKLODQUADTREE_H
@@ -0,0 +1,77 @@
+//
+// Created by Lucas Wang on 2024-08-24.
+//
+
+#include "ChunkMeshCache.h"
+
+ChunkMeshCache::ChunkMeshCache(std::size_t byteBudget) : m_byteBudget(byteBudget) {
+
+}
+
+std::uint64_t ChunkMeshCache::MakeKey(int x, int z) {
+    // Both coordinates keep all their bits, so unlike an XOR of the two no pair of chunks collides
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(z);
+}
+
+void ChunkMeshCache::Put(int x, int z, Terrain::MeshData&& mesh) {
+    std::size_t size = mesh.GetSize();
+    if (size == 0 || size > m_byteBudget) {
+        return;
+    }
+
+    std::uint64_t key = MakeKey(x, z);
+    auto found = m_lookup.find(key);
+    if (found != m_lookup.end()) {
+        m_size -= found->second->Mesh.GetSize();
+        m_entries.erase(found->second);
+        m_lookup.erase(found);
+    }
+
+    m_entries.push_front(Entry{ key, std::move(mesh) });
+    m_lookup[key] = m_entries.begin();
+    m_size += size;
+    Trim();
+}
+
+bool ChunkMeshCache::Take(int x, int z, Terrain::MeshData& mesh) {
+    auto found = m_lookup.find(MakeKey(x, z));
+    if (found == m_lookup.end()) {
+        return false;
+    }
+    mesh = std::move(found->second->Mesh);
+    m_size -= mesh.GetSize();
+    m_entries.erase(found->second);
+    m_lookup.erase(found);
+    return true;
+}
+
+void ChunkMeshCache::Clear() {
+    m_entries.clear();
+    m_lookup.clear();
+    m_size = 0;
+}
+
+void ChunkMeshCache::SetByteBudget(std::size_t byteBudget) {
+    m_byteBudget = byteBudget;
+    Trim();
+}
+
+std::size_t ChunkMeshCache::GetByteBudget() const {
+    return m_byteBudget;
+}
+
+std::size_t ChunkMeshCache::GetSize() const {
+    return m_size;
+}
+
+std::size_t ChunkMeshCache::GetEntryCount() const {
+    return m_entries.size();
+}
+
+void ChunkMeshCache::Trim() {
+    while (m_size > m_byteBudget && !m_entries.empty()) {
+        m_size -= m_entries.back().Mesh.GetSize();
+        m_lookup.erase(m_entries.back().Key);
+        m_entries.pop_back();
+    }
+}
@@ -0,0 +1,47 @@
+//
+// Created by Lucas Wang on 2024-08-24.
+//
+
+#ifndef TERRAINRENDERING_CHUNKMESHCACHE_H
+#define TERRAINRENDERING_CHUNKMESHCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include "terrain.h"
+
+// Bounded LRU of the CPU meshes of recently evicted chunks. A chunk that comes back into view
+// before its mesh is pushed out only needs an upload instead of a full regeneration.
+class ChunkMeshCache {
+public:
+    explicit ChunkMeshCache(std::size_t byteBudget = 64 * 1024 * 1024);
+
+    void Put(int x, int z, Terrain::MeshData&& mesh);
+    // Moves the mesh out of the cache if present
+    bool Take(int x, int z, Terrain::MeshData& mesh);
+    void Clear();
+
+    void SetByteBudget(std::size_t byteBudget);
+    std::size_t GetByteBudget() const;
+    std::size_t GetSize() const;
+    std::size_t GetEntryCount() const;
+
+private:
+    struct Entry {
+        std::uint64_t Key;
+        Terrain::MeshData Mesh;
+    };
+
+    // Most recently used first
+    std::list<Entry> m_entries;
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> m_lookup;
+    std::size_t m_byteBudget;
+    std::size_t m_size = 0;
+
+    static std::uint64_t MakeKey(int x, int z);
+    void Trim();
+};
+
+
+#endif //TERRAINRENDERING_CHUNKMESHCACHE_H
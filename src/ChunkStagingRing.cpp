@@ -0,0 +1,137 @@
+//
+// Created by Lucas Wang on 2024-08-30.
+//
+
+#include "ChunkStagingRing.h"
+#include "GLExtensions.h"
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+static PFNGLBUFFERSTORAGEPROC s_bufferStorage = nullptr;
+
+// Keeps every region aligned for the vertex structs written into it
+static const std::size_t kAlignment = 16;
+
+bool ChunkStagingRing::LoadFunctions(GLADloadproc load) {
+    s_bufferStorage = nullptr;
+    if (GLExtensions::HasVersion(4, 4) || GLExtensions::HasExtension("GL_ARB_buffer_storage")) {
+        s_bufferStorage = reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(load("glBufferStorage"));
+    }
+    return s_bufferStorage != nullptr;
+}
+
+bool ChunkStagingRing::IsSupported() {
+    return s_bufferStorage != nullptr;
+}
+
+ChunkStagingRing::~ChunkStagingRing() {
+    for (Entry& entry : m_entries) {
+        if (entry.Fence) {
+            glDeleteSync(entry.Fence);
+        }
+    }
+    if (m_buffer != 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, m_buffer);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &m_buffer);
+    }
+}
+
+bool ChunkStagingRing::Init(std::size_t capacity) {
+    if (!IsSupported() || m_buffer != 0) {
+        return m_buffer != 0;
+    }
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_COPY_READ_BUFFER, m_buffer);
+    s_bufferStorage(GL_COPY_READ_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, flags);
+    m_mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(capacity), flags));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    if (!m_mapped) {
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+        return false;
+    }
+    m_capacity = capacity;
+    return true;
+}
+
+bool ChunkStagingRing::IsInitialized() const {
+    return m_mapped != nullptr;
+}
+
+GLuint ChunkStagingRing::GetBuffer() const {
+    return m_buffer;
+}
+
+bool ChunkStagingRing::Reserve(std::size_t size, Region& region) {
+    size = (size + kAlignment - 1) / kAlignment * kAlignment;
+    if (!m_mapped || size == 0 || size > m_capacity) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t offset = 0;
+    if (!m_entries.empty()) {
+        std::size_t tail = m_entries.front().Offset;
+        std::size_t head = m_entries.back().Offset + m_entries.back().Size;
+        if (head > tail) {
+            // Free space is after head and, by wrapping around, before tail
+            if (m_capacity - head >= size) {
+                offset = head;
+            } else if (tail >= size) {
+                offset = 0;
+            } else {
+                return false;
+            }
+        } else if (tail - head >= size) {
+            offset = head;
+        } else {
+            return false;
+        }
+    }
+
+    m_entries.push_back(Entry{ offset, size });
+    region.Id = m_frontId + m_entries.size() - 1;
+    region.Offset = offset;
+    region.Size = size;
+    region.Data = m_mapped + offset;
+    return true;
+}
+
+void ChunkStagingRing::Fence(const Region& region) {
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry& entry = m_entries[region.Id - m_frontId];
+    entry.Fence = fence;
+    entry.Released = true;
+}
+
+void ChunkStagingRing::Release(const Region& region) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[region.Id - m_frontId].Released = true;
+}
+
+void ChunkStagingRing::Retire() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (!m_entries.empty() && m_entries.front().Released) {
+        Entry& entry = m_entries.front();
+        if (entry.Fence) {
+            if (glClientWaitSync(entry.Fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+                break;
+            }
+            glDeleteSync(entry.Fence);
+        }
+        m_entries.pop_front();
+        ++m_frontId;
+    }
+}
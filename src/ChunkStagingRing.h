@@ -0,0 +1,69 @@
+//
+// Created by Lucas Wang on 2024-08-30.
+//
+
+#ifndef TERRAINRENDERING_CHUNKSTAGINGRING_H
+#define TERRAINRENDERING_CHUNKSTAGINGRING_H
+
+#include "glad/glad.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+// A persistently mapped, coherent buffer that worker threads write finished chunk vertices
+// straight into. The GL thread then copies each chunk into its vertex buffer on the GPU and
+// fences the region, which is reused once the fence has signalled. Regions are handed out in
+// ring order and reclaimed from the oldest, so a region that is still pending holds back the
+// ones reserved after it.
+class ChunkStagingRing {
+public:
+    struct Region {
+        std::uint64_t Id = 0;
+        std::size_t Offset = 0;
+        std::size_t Size = 0;
+        void* Data = nullptr;
+    };
+
+    // Needs GL 4.4 or ARB_buffer_storage. Call once after gladLoadGLLoader().
+    static bool LoadFunctions(GLADloadproc load);
+    static bool IsSupported();
+
+    ChunkStagingRing() = default;
+    ~ChunkStagingRing();
+    ChunkStagingRing(const ChunkStagingRing&) = delete;
+    ChunkStagingRing& operator=(const ChunkStagingRing&) = delete;
+
+    // GL thread only. Returns false when persistent mapping is unsupported.
+    bool Init(std::size_t capacity);
+    bool IsInitialized() const;
+    GLuint GetBuffer() const;
+
+    // Safe to call from worker threads. Fails instead of waiting when the ring is full.
+    bool Reserve(std::size_t size, Region& region);
+    // GL thread only, after the copy out of the region has been issued
+    void Fence(const Region& region);
+    // Gives the region back without a copy, e.g. for a chunk evicted before its upload
+    void Release(const Region& region);
+    // GL thread only. Reclaims the oldest regions whose copies have finished.
+    void Retire();
+
+private:
+    struct Entry {
+        std::size_t Offset;
+        std::size_t Size;
+        bool Released = false;
+        GLsync Fence = nullptr;
+    };
+
+    GLuint m_buffer = 0;
+    unsigned char* m_mapped = nullptr;
+    std::size_t m_capacity = 0;
+    std::mutex m_mutex;
+    // Oldest first; the entry for Id lives at Id - m_frontId
+    std::deque<Entry> m_entries;
+    std::uint64_t m_frontId = 0;
+};
+
+
+#endif //TERRAINRENDERING_CHUNKSTAGINGRING_H
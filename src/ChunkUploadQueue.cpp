@@ -0,0 +1,88 @@
+//
+// Created by Lucas Wang on 2024-08-10.
+//
+
+#include "ChunkUploadQueue.h"
+#include <algorithm>
+#include <chrono>
+
+ChunkUploadQueue::ChunkUploadQueue(std::size_t byteBudget, float timeBudgetMs)
+        : m_byteBudget(byteBudget), m_timeBudgetMs(timeBudgetMs) {
+
+}
+
+void ChunkUploadQueue::Push(Terrain* chunk) {
+    m_pending.push_back(chunk);
+}
+
+int ChunkUploadQueue::Process(int centerX, int centerZ) {
+    m_bytesUploadedLastFrame = 0;
+
+    auto isCancelled = [](Terrain* chunk) {
+        if (chunk->IsCancelled()) {
+            delete chunk;
+            return true;
+        }
+        return false;
+    };
+    m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), isCancelled), m_pending.end());
+    if (m_pending.empty()) {
+        return 0;
+    }
+
+    // Nearest chunks go to the back so they can be popped off cheaply
+    auto distanceSq = [centerX, centerZ](const Terrain* chunk) {
+        int dx = chunk->GetChunkX() - centerX;
+        int dz = chunk->GetChunkZ() - centerZ;
+        return dx * dx + dz * dz;
+    };
+    std::sort(m_pending.begin(), m_pending.end(), [&](const Terrain* a, const Terrain* b) {
+        return distanceSq(a) > distanceSq(b);
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    int uploaded = 0;
+    while (!m_pending.empty()) {
+        Terrain* chunk = m_pending.back();
+        std::size_t size = chunk->GetUploadSize();
+
+        // Always upload at least one chunk so a chunk larger than the budget cannot stall the queue
+        if (uploaded > 0) {
+            float elapsedMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (m_bytesUploadedLastFrame + size > m_byteBudget || elapsedMs >= m_timeBudgetMs) {
+                break;
+            }
+        }
+
+        chunk->Upload();
+        m_pending.pop_back();
+        m_bytesUploadedLastFrame += size;
+        ++uploaded;
+    }
+    return uploaded;
+}
+
+void ChunkUploadQueue::Clear() {
+    for (Terrain* chunk : m_pending) {
+        if (chunk->IsCancelled()) {
+            delete chunk;
+        }
+    }
+    m_pending.clear();
+}
+
+void ChunkUploadQueue::SetByteBudget(std::size_t byteBudget) {
+    m_byteBudget = byteBudget;
+}
+
+void ChunkUploadQueue::SetTimeBudget(float timeBudgetMs) {
+    m_timeBudgetMs = timeBudgetMs;
+}
+
+std::size_t ChunkUploadQueue::GetPendingCount() const {
+    return m_pending.size();
+}
+
+std::size_t ChunkUploadQueue::GetBytesUploadedLastFrame() const {
+    return m_bytesUploadedLastFrame;
+}
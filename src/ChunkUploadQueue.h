@@ -0,0 +1,38 @@
+//
+// Created by Lucas Wang on 2024-08-10.
+//
+
+#ifndef TERRAINRENDERING_CHUNKUPLOADQUEUE_H
+#define TERRAINRENDERING_CHUNKUPLOADQUEUE_H
+
+#include <cstddef>
+#include <vector>
+#include "terrain.h"
+
+// Holds chunks whose CPU mesh is ready and spreads their GL uploads over several frames.
+// Each Process() call uploads the chunks nearest to the camera first and stops once the
+// per-frame byte or time budget is spent; whatever is left carries over to the next frame.
+class ChunkUploadQueue {
+public:
+    explicit ChunkUploadQueue(std::size_t byteBudget = 8 * 1024 * 1024, float timeBudgetMs = 2.0f);
+
+    void Push(Terrain* chunk);
+    // Must be called on the GL thread. Cancelled chunks are freed instead of uploaded.
+    int Process(int centerX, int centerZ);
+    // Frees the cancelled chunks still waiting and forgets the rest, which belong to the caller
+    void Clear();
+
+    void SetByteBudget(std::size_t byteBudget);
+    void SetTimeBudget(float timeBudgetMs);
+    std::size_t GetPendingCount() const;
+    std::size_t GetBytesUploadedLastFrame() const;
+
+private:
+    std::vector<Terrain*> m_pending;
+    std::size_t m_byteBudget;
+    float m_timeBudgetMs;
+    std::size_t m_bytesUploadedLastFrame = 0;
+};
+
+
+#endif //TERRAINRENDERING_CHUNKUPLOADQUEUE_H
@@ -0,0 +1,79 @@
+//
+// Created by Lucas Wang on 2024-08-22.
+//
+
+#include "ChunkWindow.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+ChunkWindow::ChunkWindow(int radiusX, int radiusZ, WindowShape shape)
+        : m_radiusX(std::max(0, radiusX)), m_radiusZ(std::max(0, radiusZ)) {
+    m_halfWidths.resize(2 * m_radiusZ + 1, m_radiusX);
+    if (shape == WindowShape::Ellipse) {
+        // Half a chunk of slack on each radius, otherwise the outermost rows and columns
+        // would shrink to a single chunk
+        float rx = m_radiusX + 0.5f;
+        float rz = m_radiusZ + 0.5f;
+        for (int dz = -m_radiusZ; dz <= m_radiusZ; ++dz) {
+            float t = dz / rz;
+            m_halfWidths[dz + m_radiusZ] = std::min(m_radiusX, static_cast<int>(std::floor(rx * std::sqrt(1.0f - t * t))));
+        }
+    }
+}
+
+int ChunkWindow::HalfWidth(int dz) const {
+    if (std::abs(dz) > m_radiusZ) {
+        return -1;
+    }
+    return m_halfWidths[dz + m_radiusZ];
+}
+
+bool ChunkWindow::Contains(int dx, int dz) const {
+    return std::abs(dx) <= HalfWidth(dz);
+}
+
+int ChunkWindow::GetRadiusX() const {
+    return m_radiusX;
+}
+
+int ChunkWindow::GetRadiusZ() const {
+    return m_radiusZ;
+}
+
+void ChunkWindow::AppendDifference(const ChunkWindow& a, int ax, int az,
+                                   const ChunkWindow& b, int bx, int bz,
+                                   std::vector<std::pair<int, int>>& out) {
+    for (int z = az - a.m_radiusZ; z <= az + a.m_radiusZ; ++z) {
+        int aHalf = a.HalfWidth(z - az);
+        int aBegin = ax - aHalf;
+        int aEnd = ax + aHalf;
+
+        int bHalf = b.HalfWidth(z - bz);
+        if (bHalf < 0) {
+            for (int x = aBegin; x <= aEnd; ++x) {
+                out.emplace_back(x, z);
+            }
+            continue;
+        }
+
+        // Whatever of [aBegin, aEnd] lies left and right of b's span on this row
+        int bBegin = bx - bHalf;
+        int bEnd = bx + bHalf;
+        for (int x = aBegin; x <= std::min(aEnd, bBegin - 1); ++x) {
+            out.emplace_back(x, z);
+        }
+        for (int x = std::max(aBegin, bEnd + 1); x <= aEnd; ++x) {
+            out.emplace_back(x, z);
+        }
+    }
+}
+
+void ChunkWindow::AppendAll(int centerX, int centerZ, std::vector<std::pair<int, int>>& out) const {
+    for (int dz = -m_radiusZ; dz <= m_radiusZ; ++dz) {
+        int half = m_halfWidths[dz + m_radiusZ];
+        for (int dx = -half; dx <= half; ++dx) {
+            out.emplace_back(centerX + dx, centerZ + dz);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+//
+// Created by Lucas Wang on 2024-08-22.
+//
+
+#ifndef TERRAINRENDERING_CHUNKWINDOW_H
+#define TERRAINRENDERING_CHUNKWINDOW_H
+
+#include <utility>
+#include <vector>
+
+enum class WindowShape {
+    Rectangle,
+    Ellipse
+};
+
+// Set of chunk offsets around the camera chunk that should be resident, stored as one
+// contiguous span of x offsets per row so window differences can be walked row by row.
+class ChunkWindow {
+public:
+    ChunkWindow(int radiusX, int radiusZ, WindowShape shape = WindowShape::Rectangle);
+
+    bool Contains(int dx, int dz) const;
+    int GetRadiusX() const;
+    int GetRadiusZ() const;
+
+    // Appends every chunk of window a centred on (ax, az) that is not in window b centred on
+    // (bx, bz). Costs one step per row plus one per chunk appended, independent of the area.
+    static void AppendDifference(const ChunkWindow& a, int ax, int az,
+                                 const ChunkWindow& b, int bx, int bz,
+                                 std::vector<std::pair<int, int>>& out);
+    void AppendAll(int centerX, int centerZ, std::vector<std::pair<int, int>>& out) const;
+
+private:
+    int m_radiusX;
+    int m_radiusZ;
+    // Half width of each row, indexed by dz + radiusZ
+    std::vector<int> m_halfWidths;
+
+    int HalfWidth(int dz) const;
+};
+
+
+#endif //TERRAINRENDERING_CHUNKWINDOW_H
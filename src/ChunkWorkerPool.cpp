@@ -0,0 +1,39 @@
+//
+// Created by Lucas Wang on 2024-08-09.
+//
+
+#include "ChunkWorkerPool.h"
+#include <thread>
+#include "TaskScheduler.h"
+
+ChunkWorkerPool::~ChunkWorkerPool() {
+    Shutdown();
+}
+
+void ChunkWorkerPool::Enqueue(Terrain* chunk) {
+    ++m_inFlight;
+    TaskScheduler::Instance().Submit([this, chunk]() {
+        // Chunks evicted while still queued are passed straight back so the owner can free them
+        if (!m_stopping.load() && !chunk->IsCancelled()) {
+            chunk->BuildMesh();
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_completedMutex);
+            m_completed.push_back(chunk);
+        }
+        --m_inFlight;
+    });
+}
+
+void ChunkWorkerPool::PollCompleted(std::vector<Terrain*>& completed) {
+    std::lock_guard<std::mutex> lock(m_completedMutex);
+    completed.insert(completed.end(), m_completed.begin(), m_completed.end());
+    m_completed.clear();
+}
+
+void ChunkWorkerPool::Shutdown() {
+    m_stopping = true;
+    while (m_inFlight.load() > 0) {
+        std::this_thread::yield();
+    }
+}
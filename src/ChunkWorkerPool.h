@@ -0,0 +1,35 @@
+//
+// Created by Lucas Wang on 2024-08-09.
+//
+
+#ifndef TERRAINRENDERING_CHUNKWORKERPOOL_H
+#define TERRAINRENDERING_CHUNKWORKERPOOL_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "terrain.h"
+
+// Builds chunk meshes off the render thread on the shared TaskScheduler.
+// Chunks go in through Enqueue() and come back through PollCompleted() once their CPU mesh
+// is ready; the caller keeps ownership of every chunk and does the GL upload itself.
+class ChunkWorkerPool {
+public:
+    ChunkWorkerPool() = default;
+    ~ChunkWorkerPool();
+
+    void Enqueue(Terrain* chunk);
+    // Never blocks on generation, only on the short hand-off lock
+    void PollCompleted(std::vector<Terrain*>& completed);
+    // Waits for running builds; chunks that never ran are handed back through PollCompleted()
+    void Shutdown();
+
+private:
+    std::vector<Terrain*> m_completed;
+    std::mutex m_completedMutex;
+    std::atomic<int> m_inFlight{ 0 };
+    std::atomic<bool> m_stopping{ false };
+};
+
+
+#endif //TERRAINRENDERING_CHUNKWORKERPOOL_H
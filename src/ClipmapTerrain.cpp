@@ -0,0 +1,235 @@
+//
+// Created by Lucas Wang on 2024-09-05.
+//
+
+#include "ClipmapTerrain.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include "TaskScheduler.h"
+#include "terrain.h"
+
+// Texture repeats per world unit, about the density of a 257-sample chunk at scale 20
+static const float kTexRepeatsPerUnit = 8.0f;
+// Grid cells over which a level blends into the next coarser one at its outer edge
+static const float kBlendCells = 10.0f;
+// Height texture unit, after the four material maps
+static const int kHeightTextureUnit = 4;
+
+static int WrapIndex(int index, int size) {
+    return ((index % size) + size) % size;
+}
+
+ClipmapTerrain::ClipmapTerrain(float terrainScale, int levelCount, int ringSize) :
+    m_terrainScale(terrainScale),
+    m_levelCount(levelCount),
+    m_ringSize(ringSize),
+    m_perlin(Terrain::kNoiseSeed) {
+    createResources();
+}
+
+ClipmapTerrain::~ClipmapTerrain() {
+    releaseResources();
+}
+
+void ClipmapTerrain::createResources() {
+    m_levels.assign(m_levelCount, Level{});
+
+    glGenTextures(1, &m_heightTexture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_heightTexture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R32F, m_ringSize, m_ringSize, m_levelCount, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // A two-row grid is exactly one row of quads; rows are drawn from it with a base vertex.
+    // appendQuads addresses runs of quads by offset, so the indices must stay in row-major order.
+    // Positions come from gl_VertexID, so the VAO needs no vertex buffer.
+    m_rowIndices = &IndexBufferRegistry::GetBuffer(m_ringSize, 2, IndexTopology::TriangleRows);
+    glGenVertexArrays(1, &m_VAO);
+    glBindVertexArray(m_VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_rowIndices->EBO);
+    glBindVertexArray(0);
+}
+
+void ClipmapTerrain::releaseResources() {
+    glDeleteTextures(1, &m_heightTexture);
+    glDeleteVertexArrays(1, &m_VAO);
+    m_heightTexture = 0;
+    m_VAO = 0;
+}
+
+void ClipmapTerrain::SetLevels(int levelCount, int ringSize) {
+    releaseResources();
+    m_levelCount = levelCount;
+    m_ringSize = ringSize;
+    createResources();
+}
+
+int ClipmapTerrain::GetLevelCount() const {
+    return m_levelCount;
+}
+
+int ClipmapTerrain::GetRingSize() const {
+    return m_ringSize;
+}
+
+std::size_t ClipmapTerrain::GetVertexCount() const {
+    return static_cast<std::size_t>(m_levelCount) * m_ringSize * m_ringSize;
+}
+
+std::size_t ClipmapTerrain::GetUpdatedVertexCount() const {
+    return m_updatedVertices;
+}
+
+float ClipmapTerrain::spacing(int level) const {
+    return static_cast<float>(1 << level) / m_terrainScale;
+}
+
+void ClipmapTerrain::updateLevels(float cameraX, float cameraZ) {
+    m_updatedVertices = 0;
+    const int size = m_ringSize;
+    const int half = (size - 1) / 2;
+
+    for (int level = 0; level < m_levelCount; ++level) {
+        // Even origins put every level's edges on grid lines of the next coarser level
+        float step = spacing(level);
+        int originX = 2 * static_cast<int>(std::floor(cameraX / step * 0.5f)) - half;
+        int originZ = 2 * static_cast<int>(std::floor(cameraZ / step * 0.5f)) - half;
+
+        Level& current = m_levels[level];
+        int dx = originX - current.OriginX;
+        int dz = originZ - current.OriginZ;
+        if (!current.Valid || std::abs(dx) >= size || std::abs(dz) >= size) {
+            refreshRect(level, originX, originZ, size, size);
+        } else {
+            // Columns scrolled in along x, over the full new depth
+            if (dx > 0) {
+                refreshRect(level, current.OriginX + size, originZ, dx, size);
+            } else if (dx < 0) {
+                refreshRect(level, originX, originZ, -dx, size);
+            }
+            // Rows scrolled in along z, over the columns that were already there
+            int keptX = std::max(originX, current.OriginX);
+            int keptWidth = std::min(originX, current.OriginX) + size - keptX;
+            if (dz > 0) {
+                refreshRect(level, keptX, current.OriginZ + size, keptWidth, dz);
+            } else if (dz < 0) {
+                refreshRect(level, keptX, originZ, keptWidth, -dz);
+            }
+        }
+        current.OriginX = originX;
+        current.OriginZ = originZ;
+        current.Valid = true;
+    }
+}
+
+void ClipmapTerrain::refreshRect(int level, int gridX, int gridZ, int width, int depth) {
+    if (width <= 0 || depth <= 0) {
+        return;
+    }
+
+    float step = spacing(level);
+    m_scratch.resize(static_cast<std::size_t>(width) * depth);
+    TaskScheduler::Instance().ParallelFor(0, depth, 8, [&](int start, int end) {
+        for (int z = start; z < end; ++z) {
+            for (int x = 0; x < width; ++x) {
+                m_scratch[z * width + x] = Terrain::SampleNoiseHeight(m_perlin, (gridX + x) * step, (gridZ + z) * step, step);
+            }
+        }
+    });
+    m_updatedVertices += m_scratch.size();
+
+    // The rectangle lands at its grid coordinates modulo the ring size, so it may wrap around
+    // either edge of the layer and is then written in up to four pieces
+    const int texelX = WrapIndex(gridX, m_ringSize);
+    const int texelZ = WrapIndex(gridZ, m_ringSize);
+    const int firstWidth = std::min(width, m_ringSize - texelX);
+    const int firstDepth = std::min(depth, m_ringSize - texelZ);
+    const int pieceX[2][3] = { { texelX, 0, firstWidth }, { 0, firstWidth, width - firstWidth } };
+    const int pieceZ[2][3] = { { texelZ, 0, firstDepth }, { 0, firstDepth, depth - firstDepth } };
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_heightTexture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+    for (const auto& px : pieceX) {
+        for (const auto& pz : pieceZ) {
+            if (px[2] <= 0 || pz[2] <= 0) {
+                continue;
+            }
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, px[1]);
+            glPixelStorei(GL_UNPACK_SKIP_ROWS, pz[1]);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, px[0], pz[0], level, px[2], pz[2], 1, GL_RED, GL_FLOAT, m_scratch.data());
+        }
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void ClipmapTerrain::appendQuads(int x0, int z0, int x1, int z1) {
+    if (x1 <= x0) {
+        return;
+    }
+    std::size_t indexSize = m_rowIndices->Type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    for (int z = z0; z < z1; ++z) {
+        m_counts.push_back((x1 - x0) * 6);
+        m_offsets.push_back(reinterpret_cast<const void*>(static_cast<std::uintptr_t>(x0) * 6 * indexSize));
+        m_baseVertices.push_back(z * m_ringSize);
+    }
+}
+
+void ClipmapTerrain::renderTerrain(Shader& shader, const glm::vec3& cameraPosition) {
+    const int quads = m_ringSize - 1;
+    const int hole = quads / 2;
+
+    shader.setInt("gridSize", m_ringSize);
+    shader.setVec3("cameraPos", cameraPosition);
+    shader.setFloat("texScale", kTexRepeatsPerUnit);
+    shader.setFloat("blendWidth", kBlendCells);
+    shader.setInt("heightLevels", kHeightTextureUnit);
+    glActiveTexture(GL_TEXTURE0 + kHeightTextureUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_heightTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(m_VAO);
+    for (int level = 0; level < m_levelCount; ++level) {
+        const Level& current = m_levels[level];
+        if (!current.Valid) {
+            continue;
+        }
+
+        m_counts.clear();
+        m_offsets.clear();
+        m_baseVertices.clear();
+        if (level == 0) {
+            appendQuads(0, 0, quads, quads);
+        } else {
+            // Leave out the quads covered by the finer level, which sits on this level's grid lines
+            const Level& finer = m_levels[level - 1];
+            int holeX = finer.OriginX / 2 - current.OriginX;
+            int holeZ = finer.OriginZ / 2 - current.OriginZ;
+            appendQuads(0, 0, quads, holeZ);
+            appendQuads(0, holeZ, holeX, holeZ + hole);
+            appendQuads(holeX + hole, holeZ, quads, holeZ + hole);
+            appendQuads(0, holeZ + hole, quads, quads);
+        }
+
+        shader.setInt("level", level);
+        shader.setInt("originX", current.OriginX);
+        shader.setInt("originZ", current.OriginZ);
+        shader.setFloat("levelSpacing", spacing(level));
+        const bool hasCoarser = level + 1 < m_levelCount && m_levels[level + 1].Valid;
+        shader.setBool("hasCoarser", hasCoarser);
+        if (hasCoarser) {
+            shader.setInt("coarseOriginX", m_levels[level + 1].OriginX);
+            shader.setInt("coarseOriginZ", m_levels[level + 1].OriginZ);
+        }
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, m_counts.data(), m_rowIndices->Type, m_offsets.data(),
+                                      static_cast<GLsizei>(m_counts.size()), m_baseVertices.data());
+    }
+    glBindVertexArray(0);
+}
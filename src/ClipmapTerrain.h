@@ -0,0 +1,76 @@
+//
+// Created by Lucas Wang on 2024-09-05.
+//
+
+#ifndef TERRAINRENDERING_CLIPMAPTERRAIN_H
+#define TERRAINRENDERING_CLIPMAPTERRAIN_H
+
+#include "glad/glad.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+#include "PerlinNoise.hpp"
+#include "IndexBufferRegistry.h"
+#include "shader.h"
+
+// Geometry clipmap alternative to InfiniteTerrain for long view distances. Each level is a
+// ringSize x ringSize vertex grid centered on the camera with twice the spacing of the level
+// inside it, drawn around the hole the finer level fills, so the vertex count is fixed no matter
+// how far the terrain reaches. Heights live in one texture layer per level, addressed
+// toroidally, and only the rows and columns a level scrolls onto are sampled from the noise.
+// Each level samples only the octaves its spacing can resolve, so coarse levels cost less and
+// do not alias.
+class ClipmapTerrain {
+public:
+    // ringSize must be 2^k + 1 with k >= 3
+    ClipmapTerrain(float terrainScale, int levelCount = 6, int ringSize = 129);
+    ~ClipmapTerrain();
+    ClipmapTerrain(const ClipmapTerrain&) = delete;
+    ClipmapTerrain& operator=(const ClipmapTerrain&) = delete;
+
+    void updateLevels(float cameraX, float cameraZ);
+    // Expects a shader built from clipmap.vs
+    void renderTerrain(Shader& shader, const glm::vec3& cameraPosition);
+
+    // Drops all heights; they are sampled again on the next update
+    void SetLevels(int levelCount, int ringSize);
+    int GetLevelCount() const;
+    int GetRingSize() const;
+    std::size_t GetVertexCount() const;
+    // Heights sampled by the last updateLevels()
+    std::size_t GetUpdatedVertexCount() const;
+
+private:
+    struct Level {
+        // Grid coordinates of the level's corner vertex, in units of the level's spacing
+        int OriginX = 0;
+        int OriginZ = 0;
+        bool Valid = false;
+    };
+
+    float m_terrainScale;
+    int m_levelCount;
+    int m_ringSize;
+    std::vector<Level> m_levels;
+    GLuint m_heightTexture = 0;
+    GLuint m_VAO = 0;
+    const SharedIndexBuffer* m_rowIndices = nullptr;
+    const siv::PerlinNoise m_perlin;
+    std::vector<float> m_scratch;
+    std::size_t m_updatedVertices = 0;
+
+    // Per-row draws of the current level for glMultiDrawElementsBaseVertex
+    std::vector<GLsizei> m_counts;
+    std::vector<const void*> m_offsets;
+    std::vector<GLint> m_baseVertices;
+
+    void createResources();
+    void releaseResources();
+    float spacing(int level) const;
+    // Samples the given rectangle of grid points and writes it to its toroidal place in the layer
+    void refreshRect(int level, int gridX, int gridZ, int width, int depth);
+    void appendQuads(int x0, int z0, int x1, int z1);
+};
+
+
+#endif //TERRAINRENDERING_CLIPMAPTERRAIN_H
@@ -0,0 +1,40 @@
+//
+// Created by Lucas Wang on 2024-08-18.
+//
+
+#include "Frustum.h"
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+    // glm matrices are column-major, so row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+    auto row = [&](int i) {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+    glm::vec4 x = row(0);
+    glm::vec4 y = row(1);
+    glm::vec4 z = row(2);
+    glm::vec4 w = row(3);
+
+    m_planes[0] = w + x; // left
+    m_planes[1] = w - x; // right
+    m_planes[2] = w + y; // bottom
+    m_planes[3] = w - y; // top
+    m_planes[4] = w + z; // near
+    m_planes[5] = w - z; // far
+
+    for (glm::vec4& plane : m_planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+bool Frustum::Intersects(const AABB& box) const {
+    for (const glm::vec4& plane : m_planes) {
+        // The corner furthest along the plane normal; if even that one is behind, the box is out
+        glm::vec3 corner(plane.x >= 0.0f ? box.Max.x : box.Min.x,
+                         plane.y >= 0.0f ? box.Max.y : box.Min.y,
+                         plane.z >= 0.0f ? box.Max.z : box.Min.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
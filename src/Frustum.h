@@ -0,0 +1,31 @@
+//
+// Created by Lucas Wang on 2024-08-18.
+//
+
+#ifndef TERRAINRENDERING_FRUSTUM_H
+#define TERRAINRENDERING_FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+struct AABB {
+    glm::vec3 Min;
+    glm::vec3 Max;
+};
+
+// View frustum as six inward-facing planes, extracted from a view-projection matrix.
+// Pure CPU code, it does not need a GL context.
+class Frustum {
+public:
+    Frustum() = default;
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    // Conservative: a box straddling a plane, or near a frustum corner, counts as visible
+    bool Intersects(const AABB& box) const;
+
+private:
+    // xyz is the plane normal, w the distance term
+    glm::vec4 m_planes[6];
+};
+
+
+#endif //TERRAINRENDERING_FRUSTUM_H
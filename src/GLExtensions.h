@@ -0,0 +1,19 @@
+//
+// Created by Lucas Wang on 2024-08-30.
+//
+
+#ifndef TERRAINRENDERING_GLEXTENSIONS_H
+#define TERRAINRENDERING_GLEXTENSIONS_H
+
+#include "glad/glad.h"
+
+// The bundled glad loader stops at GL 4.1, so newer entry points are loaded by hand after
+// checking for them here. Both need a current context.
+class GLExtensions {
+public:
+    static bool HasVersion(int major, int minor);
+    static bool HasExtension(const char* name);
+};
+
+
+#endif //TERRAINRENDERING_GLEXTENSIONS_H
@@ -0,0 +1,274 @@
+//
+// Created by Lucas Wang on 2024-08-14.
+//
+
+#include "IndexBufferRegistry.h"
+#include "VertexCacheOptimizer.h"
+#include <cstdint>
+#include <limits>
+
+std::mutex IndexBufferRegistry::s_mutex;
+std::map<std::pair<int, int>, std::unique_ptr<std::vector<unsigned int>>> IndexBufferRegistry::s_triangleLists;
+std::map<std::pair<int, int>, std::unique_ptr<std::vector<unsigned int>>> IndexBufferRegistry::s_optimizedTriangleLists;
+std::map<IndexBufferRegistry::Key, std::unique_ptr<SharedIndexBuffer>> IndexBufferRegistry::s_buffers;
+
+const std::vector<unsigned int>& IndexBufferRegistry::GetTriangleList(int width, int depth) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto& indices = s_triangleLists[std::make_pair(width, depth)];
+    if (!indices) {
+        indices = std::make_unique<std::vector<unsigned int>>();
+        BuildTriangleList(width, depth, *indices);
+    }
+    return *indices;
+}
+
+const std::vector<unsigned int>& IndexBufferRegistry::GetOptimizedTriangleList(int width, int depth) {
+    // Row-major order reloads every vertex once per row it touches, since a 256-vertex row is
+    // far wider than any vertex cache
+    const std::vector<unsigned int>& rowMajor = GetTriangleList(width, depth);
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto& indices = s_optimizedTriangleLists[std::make_pair(width, depth)];
+    if (!indices) {
+        indices = std::make_unique<std::vector<unsigned int>>(rowMajor);
+        VertexCacheOptimizer::Optimize(indices->data(), indices->size(), static_cast<size_t>(width) * depth);
+    }
+    return *indices;
+}
+
+const SharedIndexBuffer& IndexBufferRegistry::GetBuffer(int width, int depth, IndexTopology topology) {
+    // The triangle lists are built before taking the lock, since building them takes it as well
+    const std::vector<unsigned int>* triangleList = nullptr;
+    if (topology == IndexTopology::Triangles) {
+        triangleList = &GetOptimizedTriangleList(width, depth);
+    } else if (topology == IndexTopology::TriangleRows) {
+        triangleList = &GetTriangleList(width, depth);
+    }
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto& buffer = s_buffers[std::make_tuple(width, depth, topology)];
+    if (!buffer) {
+        buffer = std::make_unique<SharedIndexBuffer>();
+
+        // Binding to GL_ARRAY_BUFFER keeps whatever VAO is bound untouched
+        glGenBuffers(1, &buffer->EBO);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer->EBO);
+        if (topology == IndexTopology::LodNodes) {
+            // The root level reaches the far corner of the grid, so it has the largest index
+            if (static_cast<size_t>(width) * depth <= size_t(std::numeric_limits<std::uint16_t>::max()) + 1) {
+                UploadLodNodes<std::uint16_t>(width, depth, *buffer);
+            } else {
+                UploadLodNodes<std::uint32_t>(width, depth, *buffer);
+            }
+        } else if (topology == IndexTopology::MipChain) {
+            if (static_cast<size_t>(GetVertexCount(width, depth, topology)) <= size_t(std::numeric_limits<std::uint16_t>::max()) + 1) {
+                UploadMipChain<std::uint16_t>(width, depth, *buffer);
+            } else {
+                UploadMipChain<std::uint32_t>(width, depth, *buffer);
+            }
+        } else if (topology == IndexTopology::TriangleStrip) {
+            size_t vertexCount = static_cast<size_t>(width) * depth;
+            if (vertexCount <= size_t(std::numeric_limits<std::uint16_t>::max()) + 1) {
+                UploadTriangleStrip<std::uint16_t>(width, depth, *buffer);
+            } else {
+                UploadTriangleStrip<std::uint32_t>(width, depth, *buffer);
+            }
+        } else if (triangleList) {
+            buffer->Count = static_cast<GLsizei>(triangleList->size());
+            glBufferData(GL_ARRAY_BUFFER, sizeof(unsigned int) * triangleList->size(), triangleList->data(), GL_STATIC_DRAW);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    return *buffer;
+}
+
+template <typename T>
+void IndexBufferRegistry::UploadTriangleStrip(int width, int depth, SharedIndexBuffer& buffer) {
+    // The all-ones index is reserved for primitive restart. A 256x256 grid uses every 16-bit
+    // value as a vertex, so in that case rows are stitched with degenerate triangles instead.
+    const T restartIndex = std::numeric_limits<T>::max();
+    bool primitiveRestart = static_cast<size_t>(width) * depth <= restartIndex;
+
+    std::vector<T> indices;
+    BuildTriangleStrip(width, depth, primitiveRestart, indices);
+
+    buffer.Mode = GL_TRIANGLE_STRIP;
+    buffer.Type = sizeof(T) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    buffer.Count = static_cast<GLsizei>(indices.size());
+    buffer.PrimitiveRestart = primitiveRestart;
+    buffer.RestartIndex = restartIndex;
+    glBufferData(GL_ARRAY_BUFFER, sizeof(T) * indices.size(), indices.data(), GL_STATIC_DRAW);
+}
+
+template <typename T>
+void IndexBufferRegistry::UploadLodNodes(int width, int depth, SharedIndexBuffer& buffer) {
+    // Same triangles and winding as BuildTriangleList, on a grid that skips 1 << level vertices.
+    // Each level is laid out quadrant by quadrant so that a quarter node is a quarter of the range.
+    // Block levels are only ever drawn whole, so they are a single piece.
+    std::vector<T> indices;
+    int levels = GetLodLevelCount(width, depth);
+    const int chunkLevels = levels - kLodBlockLevels;
+    indices.reserve(static_cast<size_t>(levels) * kLodNodeQuads * kLodNodeQuads * 6);
+    buffer.Levels.clear();
+    for (int level = 0; level < levels; ++level) {
+        const int step = 1 << level;
+        const bool blockLevel = level >= chunkLevels;
+        const int pieces = blockLevel ? 1 : 4;
+        const int pieceQuads = blockLevel ? kLodNodeQuads >> (level - chunkLevels + 1) : kLodNodeQuads / 2;
+        IndexRange range;
+        range.First = static_cast<GLuint>(indices.size());
+        for (int quadrant = 0; quadrant < pieces; ++quadrant) {
+            const int startX = (quadrant % 2) * pieceQuads;
+            const int startZ = (quadrant / 2) * pieceQuads;
+            size_t quadrantFirst = indices.size();
+            for (int z = startZ; z < startZ + pieceQuads; ++z) {
+                for (int x = startX; x < startX + pieceQuads; ++x) {
+                    T topLeft = static_cast<T>(z * step * width + x * step);
+                    T topRight = static_cast<T>(topLeft + step);
+                    T bottomLeft = static_cast<T>(topLeft + step * width);
+                    T bottomRight = static_cast<T>(bottomLeft + step);
+
+                    indices.push_back(topLeft);
+                    indices.push_back(bottomLeft);
+                    indices.push_back(topRight);
+                    indices.push_back(topRight);
+                    indices.push_back(bottomLeft);
+                    indices.push_back(bottomRight);
+                }
+            }
+            // Reordered within the quadrant, so a quarter node stays a quarter of the range
+            VertexCacheOptimizer::Optimize(&indices[quadrantFirst], indices.size() - quadrantFirst,
+                                           static_cast<size_t>(width) * depth);
+        }
+        range.Count = static_cast<GLsizei>(indices.size() - range.First);
+        buffer.Levels.push_back(range);
+    }
+
+    buffer.Mode = GL_TRIANGLES;
+    buffer.Type = sizeof(T) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    buffer.Count = static_cast<GLsizei>(indices.size());
+    glBufferData(GL_ARRAY_BUFFER, sizeof(T) * indices.size(), indices.data(), GL_STATIC_DRAW);
+}
+
+int IndexBufferRegistry::GetMipLevelCount(int width, int depth) {
+    if (width != depth) {
+        return 0;
+    }
+    int quads = width - 1;
+    int levels = 1;
+    while (quads % 2 == 0 && quads / 2 >= kMinMipQuads) {
+        quads /= 2;
+        ++levels;
+    }
+    return levels;
+}
+
+int IndexBufferRegistry::GetVertexCount(int width, int depth, IndexTopology topology) {
+    int gridVertices = width * depth;
+    return topology == IndexTopology::MipChain ? gridVertices + 4 * width : gridVertices;
+}
+
+template <typename T>
+void IndexBufferRegistry::UploadMipChain(int width, int depth, SharedIndexBuffer& buffer) {
+    // Same triangles and winding as BuildTriangleList on a grid that skips 1 << level vertices.
+    // Each skirt quad joins two edge vertices of the level to the skirt vertices hanging below them.
+    std::vector<T> indices;
+    int levels = GetMipLevelCount(width, depth);
+    const int skirtBase = width * depth;
+    buffer.Levels.clear();
+    for (int level = 0; level < levels; ++level) {
+        const int step = 1 << level;
+        IndexRange range;
+        range.First = static_cast<GLuint>(indices.size());
+        for (int z = 0; z < depth - 1; z += step) {
+            for (int x = 0; x < width - 1; x += step) {
+                T topLeft = static_cast<T>(z * width + x);
+                T topRight = static_cast<T>(topLeft + step);
+                T bottomLeft = static_cast<T>(topLeft + step * width);
+                T bottomRight = static_cast<T>(bottomLeft + step);
+
+                indices.push_back(topLeft);
+                indices.push_back(bottomLeft);
+                indices.push_back(topRight);
+                indices.push_back(topRight);
+                indices.push_back(bottomLeft);
+                indices.push_back(bottomRight);
+            }
+        }
+
+        for (int edge = 0; edge < 4; ++edge) {
+            for (int t = 0; t < width - 1; t += step) {
+                auto gridIndex = [&](int i) {
+                    switch (edge) {
+                        case 0: return i;
+                        case 1: return (depth - 1) * width + i;
+                        case 2: return i * width;
+                        default: return i * width + width - 1;
+                    }
+                };
+                T top0 = static_cast<T>(gridIndex(t));
+                T top1 = static_cast<T>(gridIndex(t + step));
+                T bottom0 = static_cast<T>(skirtBase + edge * width + t);
+                T bottom1 = static_cast<T>(bottom0 + step);
+
+                indices.push_back(top0);
+                indices.push_back(bottom0);
+                indices.push_back(top1);
+                indices.push_back(top1);
+                indices.push_back(bottom0);
+                indices.push_back(bottom1);
+            }
+        }
+        range.Count = static_cast<GLsizei>(indices.size() - range.First);
+        VertexCacheOptimizer::Optimize(&indices[range.First], range.Count, GetVertexCount(width, depth, IndexTopology::MipChain));
+        buffer.Levels.push_back(range);
+    }
+
+    buffer.Mode = GL_TRIANGLES;
+    buffer.Type = sizeof(T) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    buffer.Count = static_cast<GLsizei>(indices.size());
+    glBufferData(GL_ARRAY_BUFFER, sizeof(T) * indices.size(), indices.data(), GL_STATIC_DRAW);
+}
+
+template <typename T>
+void IndexBufferRegistry::BuildTriangleStrip(int width, int depth, bool primitiveRestart, std::vector<T>& indices) {
+    // Each row strip alternates top and bottom vertices, which gives the same triangles and
+    // winding as BuildTriangleList. When rows are stitched instead of restarted, both the row
+    // strip and the stitch have an even length, so every row starts with the same parity.
+    indices.clear();
+    indices.reserve(static_cast<size_t>(depth - 1) * (width * 2 + 2));
+    for (int z = 0; z < depth - 1; ++z) {
+        if (z > 0) {
+            if (primitiveRestart) {
+                indices.push_back(std::numeric_limits<T>::max());
+            } else {
+                indices.push_back(indices.back());
+                indices.push_back(static_cast<T>(z * width));
+            }
+        }
+        for (int x = 0; x < width; ++x) {
+            indices.push_back(static_cast<T>(z * width + x));
+            indices.push_back(static_cast<T>((z + 1) * width + x));
+        }
+    }
+}
+
+void IndexBufferRegistry::BuildTriangleList(int width, int depth, std::vector<unsigned int>& indices) {
+    indices.clear();
+    indices.reserve(static_cast<size_t>(width - 1) * (depth - 1) * 6);
+    for (int z = 0; z < depth - 1; ++z) {
+        for (int x = 0; x < width - 1; ++x) {
+            int topLeft = (z * width) + x;
+            int topRight = topLeft + 1;
+            int bottomLeft = ((z + 1) * width) + x;
+            int bottomRight = bottomLeft + 1;
+
+            indices.push_back(topLeft);
+            indices.push_back(bottomLeft);
+            indices.push_back(topRight);
+            indices.push_back(topRight);
+            indices.push_back(bottomLeft);
+            indices.push_back(bottomRight);
+        }
+    }
+}
@@ -0,0 +1,95 @@
+//
+// Created by Lucas Wang on 2024-08-14.
+//
+
+#ifndef TERRAINRENDERING_INDEXBUFFERREGISTRY_H
+#define TERRAINRENDERING_INDEXBUFFERREGISTRY_H
+
+#include "glad/glad.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include "ChunkLodLevels.h"
+
+// Coarsest MipChain level still has this many quads a side
+const int kMinMipQuads = 16;
+
+enum class IndexTopology {
+    // 32-bit indices, 6 per quad, in vertex cache order
+    Triangles,
+    // 32-bit indices, 6 per quad, in row-major quad order, so any run of quads within a row is a
+    // contiguous index range. For callers that draw parts of the grid by offset.
+    TriangleRows,
+    // One strip per row of quads, 16-bit indices when the vertex count allows it
+    TriangleStrip,
+    // A kLodNodeQuads x kLodNodeQuads triangle list per CDLOD level, finest first, sampling every
+    // (1 << level)th vertex. Indices are relative to the node's corner, passed as the base vertex.
+    // The kLodBlockLevels levels after the chunk's own root cover the whole chunk with fewer quads.
+    LodNodes,
+    // One triangle list per mip level over the whole chunk, finest first, sampling every
+    // (1 << level)th vertex, followed by that level's skirts. The skirt vertices come after the
+    // grid, one row of width per edge in the order z = 0, z = depth - 1, x = 0, x = width - 1.
+    MipChain,
+    // A triangle list per chunk from RtinMesher, kept in the chunk's own index buffer rather than
+    // in the registry
+    Adaptive
+};
+
+struct IndexRange {
+    GLuint First = 0;
+    GLsizei Count = 0;
+};
+
+struct SharedIndexBuffer {
+    GLuint EBO = 0;
+    GLenum Mode = GL_TRIANGLES;
+    GLenum Type = GL_UNSIGNED_INT;
+    GLsizei Count = 0;
+    bool PrimitiveRestart = false;
+    GLuint RestartIndex = 0;
+    // LodNodes and MipChain only, indexed by level
+    std::vector<IndexRange> Levels;
+};
+
+// Every chunk of the same size uses the same grid indices, so they are built once per
+// (width, depth, topology) and shared by all chunk VAOs instead of living in a private EBO.
+class IndexBufferRegistry {
+public:
+    // Row-major triangle list for a width x depth grid, as drawn for IndexTopology::TriangleRows.
+    // Safe to call from worker threads.
+    static const std::vector<unsigned int>& GetTriangleList(int width, int depth);
+    // The same triangles reordered for the post-transform vertex cache, as drawn for
+    // IndexTopology::Triangles. Safe to call from worker threads.
+    static const std::vector<unsigned int>& GetOptimizedTriangleList(int width, int depth);
+    // Creates the GL buffer on first use, so it must be called on the GL thread. Not for
+    // IndexTopology::Adaptive, whose indices live with each chunk.
+    static const SharedIndexBuffer& GetBuffer(int width, int depth, IndexTopology topology);
+    // Number of MipChain levels, 1 when (width - 1) cannot be halved without going below
+    // kMinMipQuads, or 0 when the grid is not square
+    static int GetMipLevelCount(int width, int depth);
+    // Vertices the topology expects in a chunk, skirts included
+    static int GetVertexCount(int width, int depth, IndexTopology topology);
+
+private:
+    using Key = std::tuple<int, int, IndexTopology>;
+
+    static std::mutex s_mutex;
+    static std::map<std::pair<int, int>, std::unique_ptr<std::vector<unsigned int>>> s_triangleLists;
+    static std::map<std::pair<int, int>, std::unique_ptr<std::vector<unsigned int>>> s_optimizedTriangleLists;
+    static std::map<Key, std::unique_ptr<SharedIndexBuffer>> s_buffers;
+
+    static void BuildTriangleList(int width, int depth, std::vector<unsigned int>& indices);
+    template <typename T>
+    static void BuildTriangleStrip(int width, int depth, bool primitiveRestart, std::vector<T>& indices);
+    template <typename T>
+    static void UploadTriangleStrip(int width, int depth, SharedIndexBuffer& buffer);
+    template <typename T>
+    static void UploadLodNodes(int width, int depth, SharedIndexBuffer& buffer);
+    template <typename T>
+    static void UploadMipChain(int width, int depth, SharedIndexBuffer& buffer);
+};
+
+
+#endif //TERRAINRENDERING_INDEXBUFFERREGISTRY_H
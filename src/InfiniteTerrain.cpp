@@ -3,11 +3,52 @@
 //
 
 #include "InfiniteTerrain.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include "TextureLoader.h"
+#include "RtinMesher.h"
 
-InfiniteTerrain::InfiniteTerrain(int chunkSize, float terrainScale) : m_chunkSize(chunkSize), m_terrainScale(terrainScale) {
+// Room for a few dozen compact chunks or about ten standard ones in flight
+static const std::size_t kStagingRingSize = 32 * 1024 * 1024;
+// Level 0 nodes stay at full resolution up to this many node widths from the camera
+static const float kDefaultLodRangeInNodes = 3.0f;
+// A 1080p viewport with a 45 degree field of view, letting mip levels be off by two pixels
+static const float kDefaultViewportHeight = 1080.0f;
+static const float kDefaultFovY = glm::radians(45.0f);
+static const float kDefaultMaxPixelError = 2.0f;
+// Two grid spacings at the demo's terrain scale; cuts the Perlin chunks to about a sixth of the triangles
+static const float kDefaultAdaptiveMaxError = 0.1f;
+
+InfiniteTerrain::InfiniteTerrain(int chunkSize, float terrainScale, int viewRadius, int unloadMargin) :
+    m_chunkSize(chunkSize),
+    m_terrainScale(terrainScale),
+    m_heightTextures(chunkSize),
+    m_lod(chunkSize, terrainScale, kDefaultLodRangeInNodes * kLodNodeQuads / terrainScale),
+    m_screenSpaceError(kDefaultViewportHeight, kDefaultFovY, kDefaultMaxPixelError),
+    m_adaptiveMaxError(kDefaultAdaptiveMaxError),
+    m_window(viewRadius, viewRadius),
+    m_unloadWindow(viewRadius + unloadMargin, viewRadius + unloadMargin),
+    chunks(2 * (viewRadius + unloadMargin) + 1, 2 * (viewRadius + unloadMargin) + 1) {
     LoadTextures();
+    m_stagingRing.Init(kStagingRingSize);
+}
+
+InfiniteTerrain::~InfiniteTerrain() {
+    m_workers.Shutdown();
+    m_workers.PollCompleted(m_completedChunks);
+    // Chunks still in the map are owned there, only the evicted in-flight ones are left to free
+    for (Terrain* chunk : m_completedChunks) {
+        if (chunk->IsCancelled()) {
+            delete chunk;
+        }
+    }
+    m_completedChunks.clear();
+    m_uploadQueue.Clear();
+
+    for (auto& slot : chunks.GetSlots()) {
+        delete slot.Chunk;
+    }
 }
 
 void InfiniteTerrain::LoadTextures() {
@@ -26,42 +67,284 @@ void InfiniteTerrain::LoadTextures() {
 }
 
 void InfiniteTerrain::updateChunks(float cameraX, float cameraZ) {
-    int currentChunkX = static_cast<int>(cameraX * m_terrainScale / m_chunkSize);
-    int currentChunkZ = static_cast<int>(cameraZ * m_terrainScale / m_chunkSize);
+    int currentChunkX = chunkCoordinate(cameraX);
+    int currentChunkZ = chunkCoordinate(cameraZ);
 //    std::cout << "Current chunk: " << currentChunkX << " " << currentChunkZ << std::endl;
-    for (int dz = -2; dz <= 2; dz++) {
-        for (int dx = -2; dx <= 2; dx++) {
-            int newX = currentChunkX + dx;
-            int newZ = currentChunkZ + dz;
-            auto chunkPos = std::make_pair(newX, newZ);
-
-            if (chunks.find(chunkPos) == chunks.end()) {
-                chunks[chunkPos] = new Terrain(newX, newZ, m_chunkSize, m_terrainScale);
-                chunks[chunkPos]->Generate();
+    if (!m_hasLoadCenter || currentChunkX != m_loadCenterX || currentChunkZ != m_loadCenterZ) {
+        m_ringChunks.clear();
+        if (m_hasLoadCenter) {
+            ChunkWindow::AppendDifference(m_window, currentChunkX, currentChunkZ,
+                                          m_window, m_loadCenterX, m_loadCenterZ, m_ringChunks);
+        } else {
+            m_window.AppendAll(currentChunkX, currentChunkZ, m_ringChunks);
+        }
+        m_hasLoadCenter = true;
+        m_loadCenterX = currentChunkX;
+        m_loadCenterZ = currentChunkZ;
+
+        // Nearest chunks are queued first so they are generated first
+        std::sort(m_ringChunks.begin(), m_ringChunks.end(), [&](const auto& a, const auto& b) {
+            int da = (a.first - currentChunkX) * (a.first - currentChunkX) + (a.second - currentChunkZ) * (a.second - currentChunkZ);
+            int db = (b.first - currentChunkX) * (b.first - currentChunkX) + (b.second - currentChunkZ) * (b.second - currentChunkZ);
+            return da < db;
+        });
+
+        for (const auto& [newX, newZ] : m_ringChunks) {
+            if (!chunks.Find(newX, newZ)) {
+                IndexTopology topology = topologyForNewChunk();
+                Terrain* chunk = new Terrain(newX, newZ, m_chunkSize, m_terrainScale, topology, m_vertexFormat);
+                chunk->SetRetainMesh(m_meshCache.GetByteBudget() > 0);
+                chunk->SetAdaptiveMaxError(m_adaptiveMaxError);
+                chunk->SetDrawBatch(drawBatchForNewChunk(topology));
+                chunk->SetStagingRing(m_stagingRing.IsInitialized() ? &m_stagingRing : nullptr);
+                chunk->SetHeightTextures(&m_heightTextures);
+                // Whatever held this slot is outside the window now and is recycled in place
+                if (Terrain* stale = chunks.Insert(newX, newZ, chunk)) {
+                    releaseChunk(stale);
+                }
+
+                Terrain::MeshData cached;
+                if (m_meshCache.Take(newX, newZ, cached) && cached.Format == m_vertexFormat &&
+                    cached.Topology == topology) {
+                    chunk->SetMesh(std::move(cached));
+                    m_uploadQueue.Push(chunk);
+                } else {
+                    m_workers.Enqueue(chunk);
+                }
             }
         }
     }
+
+    uploadCompletedChunks(currentChunkX, currentChunkZ);
+}
+
+int InfiniteTerrain::chunkCoordinate(float position) const {
+    // Neighbouring chunks share their edge row, so chunks are m_chunkSize - 1 samples apart.
+    // Flooring keeps negative positions in their own chunk instead of folding them into chunk 0.
+    return static_cast<int>(std::floor(position * m_terrainScale / (m_chunkSize - 1)));
 }
 
-void InfiniteTerrain::renderTerrain() {
-    for (auto& pair : chunks) {
-        pair.second->Render();
+void InfiniteTerrain::SetViewRadius(int radiusX, int radiusZ, WindowShape shape, int unloadMargin) {
+    m_window = ChunkWindow(radiusX, radiusZ, shape);
+    m_unloadWindow = ChunkWindow(m_window.GetRadiusX() + unloadMargin, m_window.GetRadiusZ() + unloadMargin, shape);
+
+    // Carry over the chunks that are still inside the new window, release the rest
+    ChunkGrid resized(2 * m_unloadWindow.GetRadiusX() + 1, 2 * m_unloadWindow.GetRadiusZ() + 1);
+    for (auto& slot : chunks.GetSlots()) {
+        if (!slot.Chunk) {
+            continue;
+        }
+        if (m_hasLoadCenter && m_unloadWindow.Contains(slot.X - m_loadCenterX, slot.Z - m_loadCenterZ)) {
+            resized.Insert(slot.X, slot.Z, slot.Chunk);
+        } else {
+            releaseChunk(slot.Chunk);
+        }
     }
+    chunks = resized;
+
+    // The next update fills in the whole new window
+    m_hasLoadCenter = false;
+    m_hasUnloadCenter = false;
 }
 
-void InfiniteTerrain::cleanupChunks(float cameraX, float cameraZ) {
-    int currentChunkX = static_cast<int>(cameraX * m_terrainScale / m_chunkSize);
-    int currentChunkZ = static_cast<int>(cameraZ * m_terrainScale / m_chunkSize);
+void InfiniteTerrain::uploadCompletedChunks(int currentChunkX, int currentChunkZ) {
+    m_workers.PollCompleted(m_completedChunks);
+    for (Terrain* chunk : m_completedChunks) {
+        m_uploadQueue.Push(chunk);
+    }
+    m_completedChunks.clear();
+    m_stagingRing.Retire();
+    m_uploadQueue.Process(currentChunkX, currentChunkZ);
+}
+
+void InfiniteTerrain::SetUploadBudget(std::size_t bytesPerFrame, float msPerFrame) {
+    m_uploadQueue.SetByteBudget(bytesPerFrame);
+    m_uploadQueue.SetTimeBudget(msPerFrame);
+}
 
-    for (auto it = chunks.begin(); it != chunks.end();) {
-        int chunkX = it->first.first;
-        int chunkZ = it->first.second;
+void InfiniteTerrain::SetIndexTopology(IndexTopology topology) {
+    m_topology = topology;
+}
+
+void InfiniteTerrain::SetVertexFormat(VertexFormat vertexFormat) {
+    m_vertexFormat = vertexFormat;
+}
 
-        if (std::abs(chunkX - currentChunkX) > 2 || std::abs(chunkZ - currentChunkZ) > 2) {
-            delete it->second;
-            it = chunks.erase(it);
+void InfiniteTerrain::SetIndirectShader(Shader* shader) {
+    m_indirectShader = shader;
+}
+
+ChunkDrawBatch* InfiniteTerrain::drawBatchForNewChunk(IndexTopology topology) {
+    // Adaptive chunks each have their own indices, which a shared index buffer cannot hold
+    if (!m_indirectShader || !ChunkDrawBatch::IsSupported() || topology == IndexTopology::Adaptive ||
+        m_vertexFormat == VertexFormat::HeightTexture) {
+        return nullptr;
+    }
+    for (auto& batch : m_drawBatches) {
+        if (batch->Matches(m_vertexFormat, m_chunkSize, m_chunkSize, topology)) {
+            return batch.get();
+        }
+    }
+    m_drawBatches.push_back(std::make_unique<ChunkDrawBatch>(m_vertexFormat, m_chunkSize, m_chunkSize, topology, m_terrainScale));
+    return m_drawBatches.back().get();
+}
+
+IndexTopology InfiniteTerrain::topologyForNewChunk() const {
+    // Morph heights only exist in compact vertices
+    if (m_lodMode == ChunkLodMode::Quadtree && m_lod.GetLevelCount() > 0 && m_vertexFormat == VertexFormat::Compact) {
+        return IndexTopology::LodNodes;
+    }
+    // Skirts need vertices of their own
+    if (m_lodMode == ChunkLodMode::ScreenSpaceError && IndexBufferRegistry::GetMipLevelCount(m_chunkSize, m_chunkSize) > 1 &&
+        m_vertexFormat != VertexFormat::HeightTexture) {
+        return IndexTopology::MipChain;
+    }
+    if (m_lodMode == ChunkLodMode::Adaptive && RtinMesher::IsSupported(m_chunkSize)) {
+        return IndexTopology::Adaptive;
+    }
+    return m_topology;
+}
+
+void InfiniteTerrain::SetLodMode(ChunkLodMode mode) {
+    m_lodMode = mode;
+}
+
+void InfiniteTerrain::SetScreenSpaceError(float viewportHeight, float fovY, float maxPixelError) {
+    m_screenSpaceError = ScreenSpaceError(viewportHeight, fovY, maxPixelError);
+}
+
+void InfiniteTerrain::SetAdaptiveMaxError(float maxError) {
+    m_adaptiveMaxError = maxError;
+}
+
+void InfiniteTerrain::SetLodRange(float leafRange) {
+    m_lod = ChunkLodQuadtree(m_chunkSize, m_terrainScale, leafRange);
+}
+
+std::size_t InfiniteTerrain::GetPendingUploadCount() const {
+    return m_uploadQueue.GetPendingCount();
+}
+
+void InfiniteTerrain::renderTerrain(Shader& shader, const glm::mat4& viewProjection, const glm::vec3& cameraPosition) {
+    Frustum frustum(viewProjection);
+    m_visibleChunks = 0;
+    m_culledChunks = 0;
+    m_drawCalls = 0;
+    m_triangles = 0;
+    const std::size_t fullTriangles = static_cast<std::size_t>(m_chunkSize - 1) * (m_chunkSize - 1) * 2;
+
+    // Chunks still being generated are simply skipped until their mesh lands
+    for (auto& slot : chunks.GetSlots()) {
+        if (!slot.Chunk || !slot.Chunk->IsUploaded()) {
+            continue;
+        }
+        Terrain* chunk = slot.Chunk;
+        AABB bounds = chunk->GetBounds();
+        if (!frustum.Intersects(bounds)) {
+            ++m_culledChunks;
+            continue;
+        }
+        ++m_visibleChunks;
+
+        if (chunk->GetIndexTopology() == IndexTopology::LodNodes) {
+            m_lodNodes.clear();
+            m_lod.Select(chunk->GetChunkX(), chunk->GetChunkZ(), bounds, cameraPosition, frustum, m_lodNodes);
+            for (const LodNode& node : m_lodNodes) {
+                m_triangles += m_lod.GetTriangleCount(node);
+            }
+            if (chunk->GetDrawBatch()) {
+                chunk->AddToDrawBatch(m_lodNodes, m_lod);
+            } else {
+                chunk->RenderNodes(shader, m_lodNodes, m_lod);
+                m_drawCalls += static_cast<int>(m_lodNodes.size());
+            }
+        } else if (chunk->GetIndexTopology() == IndexTopology::MipChain) {
+            int level = m_screenSpaceError.SelectLevel(chunk->GetLevelErrors(), ScreenSpaceError::Distance(bounds, cameraPosition));
+            m_triangles += fullTriangles >> (2 * level);
+            if (chunk->GetDrawBatch()) {
+                chunk->AddToDrawBatch(level);
+            } else {
+                chunk->RenderLevel(shader, level);
+                ++m_drawCalls;
+            }
         } else {
-            ++it;
+            m_triangles += chunk->GetTriangleCount();
+            if (chunk->GetDrawBatch()) {
+                chunk->AddToDrawBatch();
+            } else {
+                chunk->Render(shader);
+                ++m_drawCalls;
+            }
+        }
+    }
+
+    if (m_indirectShader && !m_drawBatches.empty()) {
+        for (auto& batch : m_drawBatches) {
+            batch->Draw(*m_indirectShader);
+            if (batch->GetDrawCount() > 0) {
+                ++m_drawCalls;
+            }
+        }
+        shader.use();
+    }
+}
+
+int InfiniteTerrain::GetVisibleChunkCount() const {
+    return m_visibleChunks;
+}
+
+int InfiniteTerrain::GetCulledChunkCount() const {
+    return m_culledChunks;
+}
+
+int InfiniteTerrain::GetDrawCallCount() const {
+    return m_drawCalls;
+}
+
+std::size_t InfiniteTerrain::GetTriangleCount() const {
+    return m_triangles;
+}
+
+void InfiniteTerrain::cleanupChunks(float cameraX, float cameraZ) {
+    int currentChunkX = chunkCoordinate(cameraX);
+    int currentChunkZ = chunkCoordinate(cameraZ);
+    if (m_hasUnloadCenter && currentChunkX == m_unloadCenterX && currentChunkZ == m_unloadCenterZ) {
+        return;
+    }
+
+    if (m_hasUnloadCenter) {
+        m_ringChunks.clear();
+        ChunkWindow::AppendDifference(m_unloadWindow, m_unloadCenterX, m_unloadCenterZ,
+                                      m_unloadWindow, currentChunkX, currentChunkZ, m_ringChunks);
+        for (const auto& [oldX, oldZ] : m_ringChunks) {
+            if (Terrain* chunk = chunks.Remove(oldX, oldZ)) {
+                releaseChunk(chunk);
+            }
+        }
+    } else {
+        for (auto& slot : chunks.GetSlots()) {
+            if (slot.Chunk && !m_unloadWindow.Contains(slot.X - currentChunkX, slot.Z - currentChunkZ)) {
+                releaseChunk(slot.Chunk);
+                slot.Chunk = nullptr;
+            }
         }
     }
+    m_hasUnloadCenter = true;
+    m_unloadCenterX = currentChunkX;
+    m_unloadCenterZ = currentChunkZ;
+}
+
+void InfiniteTerrain::SetMeshCacheBudget(std::size_t bytes) {
+    m_meshCache.SetByteBudget(bytes);
+}
+
+void InfiniteTerrain::releaseChunk(Terrain* chunk) {
+    // A chunk that has not been uploaded yet is still referenced by the worker pool or the
+    // upload queue, which frees it once it sees the cancellation
+    if (chunk->IsUploaded()) {
+        m_meshCache.Put(chunk->GetChunkX(), chunk->GetChunkZ(), chunk->TakeMesh());
+        delete chunk;
+    } else {
+        chunk->Cancel();
+    }
 }
\ No newline at end of file
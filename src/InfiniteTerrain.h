@@ -5,29 +5,114 @@
 #ifndef TERRAINRENDERING_INFINITETERRAIN_H
 #define TERRAINRENDERING_INFINITETERRAIN_H
 
-#include <unordered_map>
-#include <utility>
+#include <vector>
 #include "terrain.h"
+#include "ChunkGrid.h"
+#include "ChunkWindow.h"
+#include "ChunkMeshCache.h"
+#include "ChunkWorkerPool.h"
+#include "ChunkUploadQueue.h"
+#include "ChunkDrawBatch.h"
+#include "ChunkStagingRing.h"
+#include "ChunkHeightTextures.h"
+#include "ChunkLodQuadtree.h"
+#include "ScreenSpaceError.h"
+#include <memory>
+
+enum class ChunkLodMode {
+    // Every chunk at full resolution
+    None,
+    // CDLOD nodes that morph between levels, see ChunkLodQuadtree
+    Quadtree,
+    // One mip level per chunk, picked each frame from its projected error, with skirts over the cracks
+    ScreenSpaceError,
+    // An RTIN mesh per chunk with only as many triangles as its error threshold needs
+    Adaptive
+};
 
 class InfiniteTerrain {
 public:
-    InfiniteTerrain(int chunkSize, float terrainScale);
+    InfiniteTerrain(int chunkSize, float terrainScale, int viewRadius = 2, int unloadMargin = 1);
+    ~InfiniteTerrain();
     void updateChunks(float cameraX, float cameraZ);
-    void renderTerrain();
+    // Chunks whose bounds fall outside the view-projection frustum are not drawn, and LOD chunks
+    // only draw the quadtree nodes or the mip level selected for the camera position
+    void renderTerrain(Shader& shader, const glm::mat4& viewProjection, const glm::vec3& cameraPosition);
     void cleanupChunks(float cameraX, float cameraZ);
     void LoadTextures();
+    // Chunks are loaded radiusX/radiusZ chunks around the camera chunk and only unloaded once they
+    // are more than unloadMargin chunks further out, so walking along a chunk edge does not churn
+    void SetViewRadius(int radiusX, int radiusZ, WindowShape shape = WindowShape::Rectangle, int unloadMargin = 1);
+    // 0 disables the cache of evicted chunk meshes
+    void SetMeshCacheBudget(std::size_t bytes);
+    void SetUploadBudget(std::size_t bytesPerFrame, float msPerFrame);
+    // Only affects chunks created after the call
+    void SetIndexTopology(IndexTopology topology);
+    // HeightTexture chunks are always drawn one by one, since each binds its own texture layer
+    void SetVertexFormat(VertexFormat vertexFormat);
+    // With a shader built from terrain_indirect.vs and a context that supports it, chunks created
+    // afterwards share one vertex buffer per layout and all visible ones go out in a single
+    // multi-draw-indirect call. Without it every chunk is drawn on its own.
+    void SetIndirectShader(Shader* shader);
+    // CDLOD needs compact vertices and a chunk size of kLodNodeQuads times a power of two plus one.
+    // Level 0 nodes are drawn up to leafRange world units away, each coarser level twice as far.
+    // Screen-space error LOD needs a chunk size of kMinMipQuads times a power of two plus one,
+    // adaptive meshes a power of two plus one; adaptive chunks are always drawn one by one.
+    // Chunks that cannot use the mode get the plain index topology. Only affects new chunks.
+    void SetLodMode(ChunkLodMode mode);
+    void SetLodRange(float leafRange);
+    // Viewport and projection used to turn mip level errors into pixels, fovY in radians
+    void SetScreenSpaceError(float viewportHeight, float fovY, float maxPixelError);
+    // Largest height error in world units adaptive chunk meshes may leave, for new chunks
+    void SetAdaptiveMaxError(float maxError);
+    std::size_t GetPendingUploadCount() const;
+    int GetVisibleChunkCount() const;
+    int GetCulledChunkCount() const;
+    int GetDrawCallCount() const;
+    std::size_t GetTriangleCount() const;
 private:
     int m_chunkSize;
     float m_terrainScale;
-    struct hash_pair {
-        template <class T1, class T2>
-        std::size_t operator()(const std::pair<T1, T2>& p) const {
-            auto hash1 = std::hash<T1>{}(p.first);
-            auto hash2 = std::hash<T2>{}(p.second);
-            return hash1 ^ hash2;
-        }
-    };
-    std::unordered_map<std::pair<int, int>, Terrain*, hash_pair> chunks;
+    IndexTopology m_topology = IndexTopology::TriangleStrip;
+    VertexFormat m_vertexFormat = VertexFormat::Compact;
+    Shader* m_indirectShader = nullptr;
+    // One per chunk layout in use; kept until destruction since chunks point at them
+    std::vector<std::unique_ptr<ChunkDrawBatch>> m_drawBatches;
+    // Only initialized when persistent mapping is supported, otherwise uploads go through glBufferData
+    ChunkStagingRing m_stagingRing;
+    // Layers of VertexFormat::HeightTexture chunks; outlives them like the draw batches
+    ChunkHeightTextures m_heightTextures;
+    ChunkLodQuadtree m_lod;
+    ChunkLodMode m_lodMode = ChunkLodMode::Quadtree;
+    ScreenSpaceError m_screenSpaceError;
+    float m_adaptiveMaxError;
+    std::vector<LodNode> m_lodNodes;
+    ChunkWindow m_window;
+    ChunkWindow m_unloadWindow;
+    ChunkMeshCache m_meshCache;
+    ChunkGrid chunks;
+    // Camera chunk seen by the last updateChunks()/cleanupChunks(), so that only the ring of
+    // chunks entering or leaving the window has to be visited when it changes
+    bool m_hasLoadCenter = false;
+    int m_loadCenterX = 0;
+    int m_loadCenterZ = 0;
+    bool m_hasUnloadCenter = false;
+    int m_unloadCenterX = 0;
+    int m_unloadCenterZ = 0;
+    std::vector<std::pair<int, int>> m_ringChunks;
+    ChunkWorkerPool m_workers;
+    std::vector<Terrain*> m_completedChunks;
+    ChunkUploadQueue m_uploadQueue;
+    int m_visibleChunks = 0;
+    int m_culledChunks = 0;
+    int m_drawCalls = 0;
+    std::size_t m_triangles = 0;
+
+    void uploadCompletedChunks(int currentChunkX, int currentChunkZ);
+    void releaseChunk(Terrain* chunk);
+    ChunkDrawBatch* drawBatchForNewChunk(IndexTopology topology);
+    IndexTopology topologyForNewChunk() const;
+    int chunkCoordinate(float position) const;
 };
 
 
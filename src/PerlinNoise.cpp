@@ -6,6 +6,7 @@
 #include <random>
 #include <algorithm>
 #include <cmath>
+#include "TaskScheduler.h"
 
 PerlinNoise::PerlinNoise(int width, int depth) {
     m_width = width;
@@ -98,55 +99,69 @@ void hydraulicErosion(std::vector<double> &heightmap, int width, int depth, int
     std::vector<double> water(heightmap.size(), 0.0);
     std::vector<double> sediment(heightmap.size(), 0.0);
 
-    for (int i = 0; i < iterations; ++i) {
-        // Water flow and sediment transport
-        for (int z = 1; z < depth - 1; ++z) {
-            for (int x = 1; x < width - 1; ++x) {
-                int idx = z * width + x;
-                double deltaHeight[4] = {
-                        heightmap[idx] - heightmap[idx + 1],     // right
-                        heightmap[idx] - heightmap[idx - 1],     // left
-                        heightmap[idx] - heightmap[idx + width], // down
-                        heightmap[idx] - heightmap[idx - width]  // up
-                };
-
-                double flow[4] = {0.0, 0.0, 0.0, 0.0};
-                double totalDeltaHeight = 0.0;
-                for (int j = 0; j < 4; ++j) {
-                    if (deltaHeight[j] > 0) {
-                        flow[j] = deltaHeight[j];
-                        totalDeltaHeight += deltaHeight[j];
-                    }
+    auto flowRows = [&](int z) {
+        for (int x = 1; x < width - 1; ++x) {
+            int idx = z * width + x;
+            double deltaHeight[4] = {
+                    heightmap[idx] - heightmap[idx + 1],     // right
+                    heightmap[idx] - heightmap[idx - 1],     // left
+                    heightmap[idx] - heightmap[idx + width], // down
+                    heightmap[idx] - heightmap[idx - width]  // up
+            };
+
+            double flow[4] = {0.0, 0.0, 0.0, 0.0};
+            double totalDeltaHeight = 0.0;
+            for (int j = 0; j < 4; ++j) {
+                if (deltaHeight[j] > 0) {
+                    flow[j] = deltaHeight[j];
+                    totalDeltaHeight += deltaHeight[j];
                 }
+            }
 
-                if (totalDeltaHeight > 0) {
-                    for (int j = 0; j < 4; ++j) {
-                        flow[j] /= totalDeltaHeight;
-                        double sedimentTransport = water[idx] * flow[j] * 0.1;
-                        sediment[idx] -= sedimentTransport;
-                        water[idx] -= sedimentTransport;
-                        if (j == 0) {
-                            sediment[idx + 1] += sedimentTransport;
-                            water[idx + 1] += sedimentTransport;
-                        } else if (j == 1) {
-                            sediment[idx - 1] += sedimentTransport;
-                            water[idx - 1] += sedimentTransport;
-                        } else if (j == 2) {
-                            sediment[idx + width] += sedimentTransport;
-                            water[idx + width] += sedimentTransport;
-                        } else if (j == 3) {
-                            sediment[idx - width] += sedimentTransport;
-                            water[idx - width] += sedimentTransport;
-                        }
+            if (totalDeltaHeight > 0) {
+                for (int j = 0; j < 4; ++j) {
+                    flow[j] /= totalDeltaHeight;
+                    double sedimentTransport = water[idx] * flow[j] * 0.1;
+                    sediment[idx] -= sedimentTransport;
+                    water[idx] -= sedimentTransport;
+                    if (j == 0) {
+                        sediment[idx + 1] += sedimentTransport;
+                        water[idx + 1] += sedimentTransport;
+                    } else if (j == 1) {
+                        sediment[idx - 1] += sedimentTransport;
+                        water[idx - 1] += sedimentTransport;
+                    } else if (j == 2) {
+                        sediment[idx + width] += sedimentTransport;
+                        water[idx + width] += sedimentTransport;
+                    } else if (j == 3) {
+                        sediment[idx - width] += sedimentTransport;
+                        water[idx - width] += sedimentTransport;
                     }
                 }
             }
         }
+    };
 
-        // Apply sediment to the heightmap
-        for (int j = 0; j < heightmap.size(); ++j) {
-            heightmap[j] += sediment[j];
+    TaskScheduler& scheduler = TaskScheduler::Instance();
+    for (int i = 0; i < iterations; ++i) {
+        // Water flow and sediment transport. A row writes into the rows directly above and below
+        // it, so rows are split into three phases by z % 3 and the rows of one phase run in parallel.
+        for (int phase = 0; phase < 3; ++phase) {
+            int firstRow = 1 + phase;
+            int numRows = (depth - 1 - firstRow + 2) / 3;
+            scheduler.ParallelFor(0, numRows, 4, [&](int begin, int end) {
+                for (int row = begin; row < end; ++row) {
+                    flowRows(firstRow + row * 3);
+                }
+            });
         }
+
+        // Apply sediment to the heightmap
+        scheduler.ParallelFor(0, static_cast<int>(heightmap.size()), 4096, [&](int begin, int end) {
+            for (int j = begin; j < end; ++j) {
+                heightmap[j] += sediment[j];
+            }
+        });
     }
 }
 
@@ -164,30 +179,36 @@ void applyGaussianBlur(std::vector<double> &heightmap, int width, int depth, dou
         kernel[i] /= sum;
     }
 
+    TaskScheduler& scheduler = TaskScheduler::Instance();
+
     // Apply the kernel in the x direction
     std::vector<double> temp(heightmap.size());
-    for (int z = 0; z < depth; ++z) {
-        for (int x = 0; x < width; ++x) {
-            double value = 0.0;
-            for (int k = -kernelRadius; k <= kernelRadius; ++k) {
-                int nx = std::min(std::max(x + k, 0), width - 1);
-                value += heightmap[z * width + nx] * kernel[k + kernelRadius];
+    scheduler.ParallelFor(0, depth, 8, [&](int begin, int end) {
+        for (int z = begin; z < end; ++z) {
+            for (int x = 0; x < width; ++x) {
+                double value = 0.0;
+                for (int k = -kernelRadius; k <= kernelRadius; ++k) {
+                    int nx = std::min(std::max(x + k, 0), width - 1);
+                    value += heightmap[z * width + nx] * kernel[k + kernelRadius];
+                }
+                temp[z * width + x] = value;
             }
-            temp[z * width + x] = value;
         }
-    }
+    });
 
     // Apply the kernel in the y direction
-    for (int x = 0; x < width; ++x) {
-        for (int z = 0; z < depth; ++z) {
-            double value = 0.0;
-            for (int k = -kernelRadius; k <= kernelRadius; ++k) {
-                int nz = std::min(std::max(z + k, 0), depth - 1);
-                value += temp[nz * width + x] * kernel[k + kernelRadius];
+    scheduler.ParallelFor(0, width, 8, [&](int begin, int end) {
+        for (int x = begin; x < end; ++x) {
+            for (int z = 0; z < depth; ++z) {
+                double value = 0.0;
+                for (int k = -kernelRadius; k <= kernelRadius; ++k) {
+                    int nz = std::min(std::max(z + k, 0), depth - 1);
+                    value += temp[nz * width + x] * kernel[k + kernelRadius];
+                }
+                heightmap[z * width + x] = value;
             }
-            heightmap[z * width + x] = value;
         }
-    }
+    });
 }
 
 double terrace(double value, int steps) {
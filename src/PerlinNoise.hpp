@@ -26,18 +26,26 @@
 //----------------------------------------------------------------------------------------
 
 # pragma once
+# include <cstddef>
 # include <cstdint>
+# include <cmath>
 # include <algorithm>
 # include <array>
 # include <iterator>
 # include <numeric>
 # include <random>
 # include <type_traits>
+# include <utility>
 
 # if __has_include(<concepts>) && defined(__cpp_concepts)
 #	include <concepts>
 # endif
 
+// Row kernels use GCC/Clang vector extensions, compiled per instruction set with target attributes
+# if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#	define SIVPERLIN_SIMD_X86
+# endif
+
 
 // Library major version
 # define SIVPERLIN_VERSION_MAJOR			3
@@ -80,9 +88,39 @@
 #	define SIVPERLIN_DEFAULT_Z (0.34567)
 # endif
 
+// By default noise2D() is still the 8-corner slice of noise3D() at z = SIVPERLIN_DEFAULT_Z; it
+// only folds the z terms into constants, so it costs nearly as much as noise3D(). The 4-corner
+// kernel on the z = 0 plane is latticeNoise2D(), which any caller can use directly.
+// Define to route noise2D() and everything built on it (octaves, rows, derivatives) through the
+// lattice kernel instead. About a third faster, but every 2D result (and so every generated
+// world) changes.
+// # define SIVPERLIN_LATTICE_NOISE2D
+
 
 namespace siv
 {
+	// How filteredOctave2D() drops the octaves above the sampling limit
+	enum class OctaveCutoff
+	{
+		// Whole octaves only; the count steps as the sample spacing crosses powers of two
+		Truncate,
+
+		// The octave straddling the limit is weighted by how much of it fits, so the result
+		// changes continuously with the sample spacing
+		Fade,
+	};
+
+	// A noise value with its partial derivatives along x and y
+	template <class Float>
+	struct NoiseDerivatives
+	{
+		Float value;
+
+		Float dx;
+
+		Float dy;
+	};
+
 	template <class Float>
 	class BasicPerlinNoise
 	{
@@ -149,9 +187,41 @@ namespace siv
 		[[nodiscard]]
 		value_type noise2D(value_type x, value_type y) const noexcept;
 
+		// 4 corners and 3 lerps on the z = 0 plane, equal to noise3D(x, y, 0). Not the same
+		// values as noise2D() unless SIVPERLIN_LATTICE_NOISE2D is defined.
+		[[nodiscard]]
+		value_type latticeNoise2D(value_type x, value_type y) const noexcept;
+
 		[[nodiscard]]
 		value_type noise3D(value_type x, value_type y, value_type z) const noexcept;
 
+		///////////////////////////////////////
+		//
+		//	Noise with its analytic derivatives, from the same lattice lookups as the value
+		//
+		//	The value is bit-identical to noise2D() and the octave2D() variants.
+		//
+
+		[[nodiscard]]
+		NoiseDerivatives<value_type> noise2DDerivatives(value_type x, value_type y) const noexcept;
+
+		// With derivativeSpacing > 0 the derivatives only carry the octaves that samples that far
+		// apart can represent, fading out as filteredOctave2D() does, while the value still sums
+		// every octave. With the default of 0 they carry every octave.
+		[[nodiscard]]
+		NoiseDerivatives<value_type> octave2DDerivatives(value_type x, value_type y, std::int32_t octaves, value_type persistence = value_type(0.5),
+			value_type derivativeSpacing = value_type(0)) const noexcept;
+
+		// Derivatives are 0 where the value is clamped
+		[[nodiscard]]
+		NoiseDerivatives<value_type> octave2D_01Derivatives(value_type x, value_type y, std::int32_t octaves, value_type persistence = value_type(0.5),
+			value_type derivativeSpacing = value_type(0)) const noexcept;
+
+		// octave2D_01Derivatives() over a row, split into values and derivatives; vectorized and
+		// matching the scalar calls as octave2D_01Row() does
+		void octave2D_01RowDerivatives(const value_type* xs, value_type y, std::size_t count, value_type* out, value_type* outDx, value_type* outDy,
+			std::int32_t octaves, value_type persistence = value_type(0.5), value_type derivativeSpacing = value_type(0)) const noexcept;
+
 		///////////////////////////////////////
 		//
 		//	Noise (The result is remapped to the range [0, 1])
@@ -180,6 +250,42 @@ namespace siv
 		[[nodiscard]]
 		value_type octave3D(value_type x, value_type y, value_type z, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
 
+		///////////////////////////////////////
+		//
+		//	Octave noise with the octave count fixed at compile time
+		//
+		//	The octave loop is unrolled against constexpr frequency and amplitude tables; the
+		//	results are bit-identical to the runtime-count versions.
+		//
+
+		template <std::int32_t Octaves>
+		[[nodiscard]]
+		value_type octave2D(value_type x, value_type y, value_type persistence = value_type(0.5)) const noexcept;
+
+		template <std::int32_t Octaves>
+		[[nodiscard]]
+		value_type octave2D_01(value_type x, value_type y, value_type persistence = value_type(0.5)) const noexcept;
+
+		template <std::int32_t Octaves>
+		void octave2D_01Row(const value_type* xs, value_type y, std::size_t count, value_type* out, value_type persistence = value_type(0.5)) const noexcept;
+
+		///////////////////////////////////////
+		//
+		//	Octave noise band-limited to a sample spacing (The result can be out of the range [-1, 1])
+		//
+		//	For samples taken sampleSpacing apart, octave i (frequency 2^i) is kept only up to
+		//	the Nyquist frequency 0.5 / sampleSpacing; finer octaves would alias and are not
+		//	evaluated at all. Equal to octave2D() once sampleSpacing <= 0.5 / 2^(octaves - 1).
+		//
+
+		[[nodiscard]]
+		value_type filteredOctave2D(value_type x, value_type y, std::int32_t octaves, value_type sampleSpacing,
+			value_type persistence = value_type(0.5), OctaveCutoff cutoff = OctaveCutoff::Fade) const noexcept;
+
+		[[nodiscard]]
+		value_type filteredOctave2D_01(value_type x, value_type y, std::int32_t octaves, value_type sampleSpacing,
+			value_type persistence = value_type(0.5), OctaveCutoff cutoff = OctaveCutoff::Fade) const noexcept;
+
 		///////////////////////////////////////
 		//
 		//	Octave noise (The result is clamped to the range [-1, 1])
@@ -208,6 +314,23 @@ namespace siv
 		[[nodiscard]]
 		value_type octave3D_01(value_type x, value_type y, value_type z, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
 
+		///////////////////////////////////////
+		//
+		//	Octave noise over a row of samples (The result is clamped and remapped to the range [0, 1])
+		//
+		//	out[i] = octave2D_01(xs[i], y, octaves, persistence) for i < count, evaluated several
+		//	samples at a time with AVX-512F or AVX2 when the CPU has them (x86 with GCC/Clang only).
+		//	The kernels never contract into FMA, so the results are bit-identical to the scalar calls
+		//	as long as those are built without FMA either, which is the default x86-64 target; apart
+		//	from the sign of a zero. Builds targeting FMA (e.g. -march=haswell) contract the scalar
+		//	code instead, and the two then differ by a few ulp: at most 2e-15 over the demo terrain.
+		//
+
+		void octave2D_01Row(const value_type* xs, value_type y, std::size_t count, value_type* out, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		// Samples x0, x0 + dx, x0 + 2 * dx, ...
+		void octave2D_01Row(value_type x0, value_type dx, value_type y, std::size_t count, value_type* out, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
 		///////////////////////////////////////
 		//
 		//	Octave noise (The result is normalized to the range [-1, 1])
@@ -243,6 +366,9 @@ namespace siv
 
 	using PerlinNoise = BasicPerlinNoise<double>;
 
+	// Twice the lanes of PerlinNoise in the row kernels: 8 per AVX2 vector, 16 per AVX-512
+	using PerlinNoiseF = BasicPerlinNoise<float>;
+
 	namespace perlin_detail
 	{
 		////////////////////////////////////////////////
@@ -283,6 +409,14 @@ namespace siv
 			return t * t * t * (t * (t * 6 - 15) + 10);
 		}
 
+		// d/dt of Fade(t)
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr Float FadeDerivative(const Float t) noexcept
+		{
+			return 30 * t * t * (t * (t - 2) + 1);
+		}
+
 		template <class Float>
 		[[nodiscard]]
 		inline constexpr Float Lerp(const Float a, const Float b, const Float t) noexcept
@@ -290,14 +424,79 @@ namespace siv
 			return (a + (b - a) * t);
 		}
 
+		// Which of x, y, z each of the 16 gradients picks for u and v, and their signs, as in
+		//	u = h < 8 ? x : y;  v = h < 4 ? y : h == 12 || h == 14 ? x : z;
+		//	return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+		// The hash is effectively random, so those branches mispredict about half the time.
+		// Looking the choices up instead, and multiplying by exactly +1 or -1, gives the same bits.
+		struct GradTable
+		{
+			std::uint8_t u[16];
+			std::uint8_t v[16];
+			std::int8_t uSign[16];
+			std::int8_t vSign[16];
+			// The gradient's x and y components, i.e. the derivatives of Grad() along x and y
+			std::int8_t dx[16];
+			std::int8_t dy[16];
+
+			constexpr GradTable() noexcept
+				: u{}, v{}, uSign{}, vSign{}, dx{}, dy{}
+			{
+				for (int h = 0; h < 16; ++h)
+				{
+					u[h] = h < 8 ? 0 : 1;
+					v[h] = h < 4 ? 1 : h == 12 || h == 14 ? 0 : 2;
+					uSign[h] = (h & 1) == 0 ? 1 : -1;
+					vSign[h] = (h & 2) == 0 ? 1 : -1;
+					dx[h] = (u[h] == 0 ? uSign[h] : 0) + (v[h] == 0 ? vSign[h] : 0);
+					dy[h] = (u[h] == 1 ? uSign[h] : 0) + (v[h] == 1 ? vSign[h] : 0);
+				}
+			}
+		};
+
+		inline constexpr GradTable GradTableInstance{};
+
 		template <class Float>
 		[[nodiscard]]
 		inline constexpr Float Grad(const std::uint8_t hash, const Float x, const Float y, const Float z) noexcept
 		{
 			const std::uint8_t h = hash & 15;
-			const Float u = h < 8 ? x : y;
-			const Float v = h < 4 ? y : h == 12 || h == 14 ? x : z;
-			return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+			const Float c[3] = { x, y, z };
+			return c[GradTableInstance.u[h]] * Float(GradTableInstance.uSign[h])
+				+ c[GradTableInstance.v[h]] * Float(GradTableInstance.vSign[h]);
+		}
+
+		// Grad() with its derivatives along x and y
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr NoiseDerivatives<Float> GradDerivatives(const std::uint8_t hash, const Float x, const Float y, const Float z) noexcept
+		{
+			const std::uint8_t h = hash & 15;
+			return{ Grad(hash, x, y, z), Float(GradTableInstance.dx[h]), Float(GradTableInstance.dy[h]) };
+		}
+
+		// Lerp() of two samples by a weight t along x, whose derivative is dt
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr NoiseDerivatives<Float> LerpX(const NoiseDerivatives<Float>& a, const NoiseDerivatives<Float>& b, const Float t, const Float dt) noexcept
+		{
+			return{ Lerp(a.value, b.value, t), Lerp(a.dx, b.dx, t) + (b.value - a.value) * dt, Lerp(a.dy, b.dy, t) };
+		}
+
+		// Lerp() of two samples by a weight t along y, whose derivative is dt
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr NoiseDerivatives<Float> LerpY(const NoiseDerivatives<Float>& a, const NoiseDerivatives<Float>& b, const Float t, const Float dt) noexcept
+		{
+			return{ Lerp(a.value, b.value, t), Lerp(a.dx, b.dx, t), Lerp(a.dy, b.dy, t) + (b.value - a.value) * dt };
+		}
+
+		// Lerp() of two samples by a constant weight
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr NoiseDerivatives<Float> LerpConstant(const NoiseDerivatives<Float>& a, const NoiseDerivatives<Float>& b, const Float t) noexcept
+		{
+			return{ Lerp(a.value, b.value, t), Lerp(a.dx, b.dx, t), Lerp(a.dy, b.dy, t) };
 		}
 
 		template <class Float>
@@ -367,6 +566,136 @@ namespace siv
 			return result;
 		}
 
+		// How many octaves fit below the Nyquist frequency of samples sampleSpacing apart, as a
+		// fraction: octave i counts fully while 2^i <= 0.5 / sampleSpacing and fades out over
+		// the next octave
+		template <class Float>
+		[[nodiscard]]
+		inline Float OctaveBandLimit(const std::int32_t octaves, const Float sampleSpacing) noexcept
+		{
+			if (!(sampleSpacing > 0))
+			{
+				return static_cast<Float>(octaves);
+			}
+
+			const Float limit = std::log2(Float(0.5) / sampleSpacing) + 1;
+			return std::clamp(limit, Float(0), static_cast<Float>(octaves));
+		}
+
+		template <class Noise, class Float>
+		[[nodiscard]]
+		inline auto FilteredOctave2D(const Noise& noise, Float x, Float y, const std::int32_t octaves, const Float sampleSpacing,
+			const Float persistence, const OctaveCutoff cutoff) noexcept
+		{
+			using value_type = Float;
+			const value_type limit = OctaveBandLimit(octaves, sampleSpacing);
+			value_type result = 0;
+			value_type amplitude = 1;
+
+			for (std::int32_t i = 0; i < limit; ++i)
+			{
+				const value_type weight = limit - i;
+
+				if (weight < 1)
+				{
+					if (cutoff == OctaveCutoff::Truncate)
+					{
+						break;
+					}
+
+					result += (noise.noise2D(x, y) * (amplitude * weight));
+					break;
+				}
+
+				// Whole octaves accumulate exactly as in Octave2D()
+				result += (noise.noise2D(x, y) * amplitude);
+				x *= 2;
+				y *= 2;
+				amplitude *= persistence;
+			}
+
+			return result;
+		}
+
+		template <class Noise, class Float>
+		[[nodiscard]]
+		inline auto Octave2DDerivatives(const Noise& noise, Float x, Float y, const std::int32_t octaves, const Float persistence,
+			const Float derivativeSpacing) noexcept
+		{
+			using value_type = Float;
+			NoiseDerivatives<value_type> result{ 0, 0, 0 };
+			value_type amplitude = 1;
+			value_type frequency = 1;
+			const value_type derivativeLimit = OctaveBandLimit(octaves, derivativeSpacing);
+
+			for (std::int32_t i = 0; i < octaves; ++i)
+			{
+				// The value accumulates exactly as in Octave2D(); each derivative picks up the
+				// octave's frequency through the chain rule. Octaves below the limit have a
+				// weight of exactly 1, so the unfiltered derivatives round as before.
+				const NoiseDerivatives<value_type> octave = noise.noise2DDerivatives(x, y);
+				const value_type weight = std::clamp(derivativeLimit - i, value_type(0), value_type(1));
+				result.value += (octave.value * amplitude);
+				result.dx += (octave.dx * (amplitude * frequency * weight));
+				result.dy += (octave.dy * (amplitude * frequency * weight));
+				x *= 2;
+				y *= 2;
+				amplitude *= persistence;
+				frequency *= 2;
+			}
+
+			return result;
+		}
+
+		// frequencies[i] = 2^i, the factor the runtime loop reaches by doubling x and y i times
+		template <class Float, std::size_t Octaves>
+		[[nodiscard]]
+		inline constexpr std::array<Float, Octaves> OctaveFrequencies() noexcept
+		{
+			std::array<Float, Octaves> frequencies{};
+			Float frequency = 1;
+
+			for (std::size_t i = 0; i < Octaves; ++i)
+			{
+				frequencies[i] = frequency;
+				frequency *= 2;
+			}
+
+			return frequencies;
+		}
+
+		// amplitudes[i] by the same recurrence as the runtime loop, so they round the same way.
+		// A constant expression for the default persistence; otherwise built once per call.
+		template <class Float, std::size_t Octaves>
+		[[nodiscard]]
+		inline constexpr std::array<Float, Octaves> OctaveAmplitudes(const Float persistence) noexcept
+		{
+			std::array<Float, Octaves> amplitudes{};
+			Float amplitude = 1;
+
+			for (std::size_t i = 0; i < Octaves; ++i)
+			{
+				amplitudes[i] = amplitude;
+				amplitude *= persistence;
+			}
+
+			return amplitudes;
+		}
+
+		template <class Noise, class Float, std::size_t... Octave>
+		[[nodiscard]]
+		inline auto FixedOctave2D(const Noise& noise, const Float x, const Float y, const std::array<Float, sizeof...(Octave)>& amplitudes,
+			std::index_sequence<Octave...>) noexcept
+		{
+			constexpr std::array<Float, sizeof...(Octave)> frequencies = OctaveFrequencies<Float, sizeof...(Octave)>();
+			Float result = 0;
+
+			// Scaling by a power of two is exact, so x * frequencies[i] is the runtime loop's x
+			((result += (noise.noise2D(x * frequencies[Octave], y * frequencies[Octave]) * amplitudes[Octave])), ...);
+
+			return result;
+		}
+
 		template <class Noise, class Float>
 		[[nodiscard]]
 		inline auto Octave3D(const Noise& noise, Float x, Float y, Float z, const std::int32_t octaves, const Float persistence) noexcept
@@ -387,6 +716,460 @@ namespace siv
 			return result;
 		}
 
+		# ifdef SIVPERLIN_SIMD_X86
+
+		// BasicPerlinNoise::noise2D() and octave2D_01() for Bytes / sizeof(Float) samples at a
+		// time that share y. The permutation lookups are done lane by lane from the 256-byte
+		// table, which stays in L1 and beats a gather; everything else runs on whole vectors in
+		// the same order of operations as the scalar code, so the results match it bit for bit.
+		// Only ever inlined into the target-specific entry points below. Vectors are passed by
+		// reference and results written through out parameters, since by value they would change
+		// the ABI between targets.
+		template <class Type, int Bytes>
+		struct SimdVector
+		{
+			typedef Type type __attribute__((vector_size(Bytes)));
+		};
+
+		template <class Float, int Bytes>
+		struct OctaveRowKernel
+		{
+			static constexpr int Lanes = Bytes / static_cast<int>(sizeof(Float));
+
+			using Int = std::conditional_t<sizeof(Float) == 8, std::uint64_t, std::uint32_t>;
+
+			using Vec = typename SimdVector<Float, Bytes>::type;
+
+			using IntVec = typename SimdVector<Int, Bytes>::type;
+
+			// cvttpd2dq/cvtdq2pd exist on every target, unlike conversions to 64-bit integers
+			using Int32Vec = typename SimdVector<std::int32_t, Lanes * 4>::type;
+
+			static constexpr int SignShift = static_cast<int>(sizeof(Int) * 8 - 1);
+
+			[[gnu::always_inline]]
+			static inline void Fade(Vec& out, const Vec& t) noexcept
+			{
+				out = t * t * t * (t * (t * Float(6) - Float(15)) + Float(10));
+			}
+
+			[[gnu::always_inline]]
+			static inline void Lerp(Vec& out, const Vec& a, const Vec& b, const Vec& t) noexcept
+			{
+				out = (a + (b - a) * t);
+			}
+
+			[[gnu::always_inline]]
+			static inline void Grad(Vec& out, const IntVec& hash, const Vec& x, const Vec& y, const Vec& z) noexcept
+			{
+				// The scalar branches as bit selects built from logical shifts, which plain AVX2
+				// and AVX-512F have for 64-bit lanes, unlike the compares and masks they replace
+				const IntVec bx = (IntVec)x;
+				const IntVec by = (IntVec)y;
+				const IntVec bz = (IntVec)z;
+				const IntVec h = hash & 15;
+				const IntVec useY = -((h >> 3) & 1);
+				const IntVec below4 = (((h >> 2) | (h >> 3)) & 1) - 1;
+				const IntVec useX = -((h >> 3) & (h >> 2) & ~h & 1);
+				IntVec u = (bx & ~useY) | (by & useY);
+				IntVec v = (by & below4) | (~below4 & ((bx & useX) | (bz & ~useX)));
+				u ^= (h & 1) << SignShift;
+				v ^= ((h >> 1) & 1) << SignShift;
+				out = (Vec)u + (Vec)v;
+			}
+
+			// Grad() with its derivatives along x and y, the gradient's x and y components
+			[[gnu::always_inline]]
+			static inline void GradDerivatives(Vec& value, Vec& dx, Vec& dy, const IntVec& hash, const Vec& x, const Vec& y, const Vec& z) noexcept
+			{
+				Grad(value, hash, x, y, z);
+				const IntVec one = (IntVec)(Vec{} + Float(1));
+				const IntVec h = hash & 15;
+				const IntVec useY = -((h >> 3) & 1);
+				const IntVec below4 = (((h >> 2) | (h >> 3)) & 1) - 1;
+				const IntVec useX = -((h >> 3) & (h >> 2) & ~h & 1);
+				const IntVec uSign = (h & 1) << SignShift;
+				const IntVec vSign = ((h >> 1) & 1) << SignShift;
+				IntVec ux = (one & ~useY) ^ uSign;
+				IntVec vx = (one & ~below4 & useX) ^ vSign;
+				IntVec uy = (one & useY) ^ uSign;
+				IntVec vy = (one & below4) ^ vSign;
+				dx = (Vec)ux + (Vec)vx;
+				dy = (Vec)uy + (Vec)vy;
+			}
+
+			// The lattice cell around each sample: corner hashes, offsets to the corners and weights
+			struct Cell
+			{
+			# ifdef SIVPERLIN_LATTICE_NOISE2D
+				IntVec h[4];
+			# else
+				IntVec h[8];
+			# endif
+				Vec fx, fx1, fy0, fy1, u, v;
+				Float dv;
+			};
+
+			[[gnu::always_inline]]
+			static inline void Locate(Cell& cell, const std::uint8_t* p, const Vec& x, const Float y) noexcept
+			{
+				// floor() as truncation corrected for negative values
+				const Int32Vec truncated = __builtin_convertvector(x, Int32Vec);
+				const Vec t = __builtin_convertvector(truncated, Vec);
+				const Vec _x = t > x ? t - Float(1) : t;
+				const Int32Vec ix = __builtin_convertvector(_x, Int32Vec) & 255;
+
+				const Float _y = std::floor(y);
+				const std::int32_t iy = static_cast<std::int32_t>(_y) & 255;
+
+				cell.fx = (x - _x);
+				const Float fy = (y - _y);
+
+				Fade(cell.u, cell.fx);
+				cell.v = Vec{} + perlin_detail::Fade(fy);
+				cell.dv = perlin_detail::FadeDerivative(fy);
+
+				cell.fx1 = cell.fx - Float(1);
+				cell.fy0 = Vec{} + fy;
+				cell.fy1 = Vec{} + (fy - Float(1));
+
+			# ifdef SIVPERLIN_LATTICE_NOISE2D
+
+				for (int lane = 0; lane < Lanes; ++lane)
+				{
+					const std::int32_t i = ix[lane];
+					const std::uint8_t A = (p[i] + iy) & 255;
+					const std::uint8_t B = (p[(i + 1) & 255] + iy) & 255;
+					cell.h[0][lane] = p[p[A]];
+					cell.h[1][lane] = p[p[B]];
+					cell.h[2][lane] = p[p[(A + 1) & 255]];
+					cell.h[3][lane] = p[p[(B + 1) & 255]];
+				}
+
+			# else
+
+				const std::int32_t iz = static_cast<std::int32_t>(std::floor(static_cast<Float>(SIVPERLIN_DEFAULT_Z))) & 255;
+
+				for (int lane = 0; lane < Lanes; ++lane)
+				{
+					const std::int32_t i = ix[lane];
+					const std::uint8_t A = (p[i] + iy) & 255;
+					const std::uint8_t B = (p[(i + 1) & 255] + iy) & 255;
+					const std::uint8_t AA = (p[A] + iz) & 255;
+					const std::uint8_t AB = (p[(A + 1) & 255] + iz) & 255;
+					const std::uint8_t BA = (p[B] + iz) & 255;
+					const std::uint8_t BB = (p[(B + 1) & 255] + iz) & 255;
+					cell.h[0][lane] = p[AA];
+					cell.h[1][lane] = p[BA];
+					cell.h[2][lane] = p[AB];
+					cell.h[3][lane] = p[BB];
+					cell.h[4][lane] = p[(AA + 1) & 255];
+					cell.h[5][lane] = p[(BA + 1) & 255];
+					cell.h[6][lane] = p[(AB + 1) & 255];
+					cell.h[7][lane] = p[(BB + 1) & 255];
+				}
+
+			# endif
+			}
+
+			// Lerp(Grad(h0, fx, y, z), Grad(h1, fx - 1, y, z), u), one edge of the lattice cell
+			[[gnu::always_inline]]
+			static inline void Edge(Vec& out, const Cell& cell, const int corner, const Vec& y, const Vec& z) noexcept
+			{
+				Vec g0, g1;
+				Grad(g0, cell.h[corner], cell.fx, y, z);
+				Grad(g1, cell.h[corner + 1], cell.fx1, y, z);
+				Lerp(out, g0, g1, cell.u);
+			}
+
+			// Edge() with its derivatives, as perlin_detail::LerpX()
+			[[gnu::always_inline]]
+			static inline void EdgeDerivatives(Vec& value, Vec& dx, Vec& dy, const Cell& cell, const Vec& du, const int corner,
+				const Vec& y, const Vec& z) noexcept
+			{
+				Vec g0, g0x, g0y, g1, g1x, g1y;
+				GradDerivatives(g0, g0x, g0y, cell.h[corner], cell.fx, y, z);
+				GradDerivatives(g1, g1x, g1y, cell.h[corner + 1], cell.fx1, y, z);
+				Lerp(value, g0, g1, cell.u);
+				Lerp(dx, g0x, g1x, cell.u);
+				dx += (g1 - g0) * du;
+				Lerp(dy, g0y, g1y, cell.u);
+			}
+
+			[[gnu::always_inline]]
+			static inline void Noise2D(Vec& out, const std::uint8_t* p, const Vec& x, const Float y) noexcept
+			{
+				Cell cell;
+				Locate(cell, p, x, y);
+
+			# ifdef SIVPERLIN_LATTICE_NOISE2D
+
+				const Vec zero{};
+				Vec q0, q1;
+				Edge(q0, cell, 0, cell.fy0, zero);
+				Edge(q1, cell, 2, cell.fy1, zero);
+
+				Lerp(out, q0, q1, cell.v);
+
+			# else
+
+				constexpr Float z = static_cast<Float>(SIVPERLIN_DEFAULT_Z);
+				const Float _z = std::floor(z);
+				const Vec fz0 = Vec{} + (z - _z);
+				const Vec fz1 = Vec{} + ((z - _z) - 1);
+				const Vec w = Vec{} + perlin_detail::Fade(z - _z);
+
+				Vec q0, q1, q2, q3;
+				Edge(q0, cell, 0, cell.fy0, fz0);
+				Edge(q1, cell, 2, cell.fy1, fz0);
+				Edge(q2, cell, 4, cell.fy0, fz1);
+				Edge(q3, cell, 6, cell.fy1, fz1);
+
+				Vec r0, r1;
+				Lerp(r0, q0, q1, cell.v);
+				Lerp(r1, q2, q3, cell.v);
+
+				Lerp(out, r0, r1, w);
+
+			# endif
+			}
+
+			// BasicPerlinNoise::noise2DDerivatives(), with the same operations in the same order
+			[[gnu::always_inline]]
+			static inline void Noise2DDerivatives(Vec& value, Vec& dx, Vec& dy, const std::uint8_t* p, const Vec& x, const Float y) noexcept
+			{
+				Cell cell;
+				Locate(cell, p, x, y);
+
+				const Vec t = cell.fx;
+				const Vec du = Float(30) * t * t * (t * (t - Float(2)) + Float(1));
+
+			# ifdef SIVPERLIN_LATTICE_NOISE2D
+
+				const Vec zero{};
+				Vec q0, q0x, q0y, q1, q1x, q1y;
+				EdgeDerivatives(q0, q0x, q0y, cell, du, 0, cell.fy0, zero);
+				EdgeDerivatives(q1, q1x, q1y, cell, du, 2, cell.fy1, zero);
+
+				Lerp(value, q0, q1, cell.v);
+				Lerp(dx, q0x, q1x, cell.v);
+				Lerp(dy, q0y, q1y, cell.v);
+				dy += (q1 - q0) * cell.dv;
+
+			# else
+
+				constexpr Float z = static_cast<Float>(SIVPERLIN_DEFAULT_Z);
+				const Float _z = std::floor(z);
+				const Vec fz0 = Vec{} + (z - _z);
+				const Vec fz1 = Vec{} + ((z - _z) - 1);
+				const Vec w = Vec{} + perlin_detail::Fade(z - _z);
+
+				Vec q0, q0x, q0y, q1, q1x, q1y, q2, q2x, q2y, q3, q3x, q3y;
+				EdgeDerivatives(q0, q0x, q0y, cell, du, 0, cell.fy0, fz0);
+				EdgeDerivatives(q1, q1x, q1y, cell, du, 2, cell.fy1, fz0);
+				EdgeDerivatives(q2, q2x, q2y, cell, du, 4, cell.fy0, fz1);
+				EdgeDerivatives(q3, q3x, q3y, cell, du, 6, cell.fy1, fz1);
+
+				Vec r0, r0x, r0y, r1, r1x, r1y;
+				Lerp(r0, q0, q1, cell.v);
+				Lerp(r0x, q0x, q1x, cell.v);
+				Lerp(r0y, q0y, q1y, cell.v);
+				r0y += (q1 - q0) * cell.dv;
+				Lerp(r1, q2, q3, cell.v);
+				Lerp(r1x, q2x, q3x, cell.v);
+				Lerp(r1y, q2y, q3y, cell.v);
+				r1y += (q3 - q2) * cell.dv;
+
+				Lerp(value, r0, r1, w);
+				Lerp(dx, r0x, r1x, w);
+				Lerp(dy, r0y, r1y, w);
+
+			# endif
+			}
+
+			[[gnu::always_inline]]
+			static inline void AddOctave(Vec& result, const std::uint8_t* p, const Vec& x, const Float y, const Float amplitude) noexcept
+			{
+				Vec noise;
+				Noise2D(noise, p, x, y);
+				result += (noise * amplitude);
+			}
+
+			template <std::size_t... Octave>
+			[[gnu::always_inline]]
+			static inline void AddFixedOctaves(Vec& result, const std::uint8_t* p, const Vec& x, const Float y,
+				const std::array<Float, sizeof...(Octave)>& amplitudes, std::index_sequence<Octave...>) noexcept
+			{
+				constexpr std::array<Float, sizeof...(Octave)> frequencies = OctaveFrequencies<Float, sizeof...(Octave)>();
+				(AddOctave(result, p, x * frequencies[Octave], y * frequencies[Octave], amplitudes[Octave]), ...);
+			}
+
+			// Fills whole vectors and returns how many samples were done; the caller finishes the rest.
+			// Octaves == 0 takes the count from octaves at runtime, anything else unrolls that many.
+			template <std::int32_t Octaves>
+			[[gnu::always_inline]]
+			static inline std::size_t Run(const std::uint8_t* p, const Float* xs, const Float y0, const std::size_t count, Float* out,
+				const std::int32_t octaves, const Float persistence) noexcept
+			{
+				constexpr std::size_t FixedOctaves = static_cast<std::size_t>(Octaves);
+				const std::array<Float, FixedOctaves> amplitudes = OctaveAmplitudes<Float, FixedOctaves>(persistence);
+
+				std::size_t i = 0;
+				for (; i + Lanes <= count; i += Lanes)
+				{
+					Vec x;
+					__builtin_memcpy(&x, xs + i, sizeof(Vec));
+					Vec result{};
+
+					if constexpr (Octaves == 0)
+					{
+						Float y = y0;
+						Float amplitude = 1;
+
+						for (std::int32_t octave = 0; octave < octaves; ++octave)
+						{
+							AddOctave(result, p, x, y, amplitude);
+							x *= 2;
+							y *= 2;
+							amplitude *= persistence;
+						}
+					}
+					else
+					{
+						AddFixedOctaves(result, p, x, y0, amplitudes, std::make_index_sequence<FixedOctaves>());
+					}
+
+					Vec remapped = (result * Float(0.5) + Float(0.5));
+					remapped = result <= Float(-1.0) ? Vec{} : remapped;
+					remapped = Float(1.0) <= result ? Vec{} + Float(1.0) : remapped;
+					__builtin_memcpy(out + i, &remapped, sizeof(Vec));
+				}
+				return i;
+			}
+
+			// Run() for octave2D_01Derivatives(), with the octave count always taken at runtime.
+			// derivativeLimit is OctaveBandLimit() of the derivative spacing.
+			[[gnu::always_inline]]
+			static inline std::size_t RunDerivatives(const std::uint8_t* p, const Float* xs, const Float y0, const std::size_t count,
+				Float* out, Float* outDx, Float* outDy, const std::int32_t octaves, const Float persistence, const Float derivativeLimit) noexcept
+			{
+				std::size_t i = 0;
+				for (; i + Lanes <= count; i += Lanes)
+				{
+					Vec x;
+					__builtin_memcpy(&x, xs + i, sizeof(Vec));
+					Float y = y0;
+					Vec result{}, resultDx{}, resultDy{};
+					Float amplitude = 1;
+					Float frequency = 1;
+
+					for (std::int32_t octave = 0; octave < octaves; ++octave)
+					{
+						Vec value, dx, dy;
+						Noise2DDerivatives(value, dx, dy, p, x, y);
+						const Float weight = std::clamp(derivativeLimit - octave, Float(0), Float(1));
+						result += (value * amplitude);
+						resultDx += (dx * (amplitude * frequency * weight));
+						resultDy += (dy * (amplitude * frequency * weight));
+						x *= 2;
+						y *= 2;
+						amplitude *= persistence;
+						frequency *= 2;
+					}
+
+					Vec remapped = (result * Float(0.5) + Float(0.5));
+					Vec remappedDx = resultDx * Float(0.5);
+					Vec remappedDy = resultDy * Float(0.5);
+					const auto clamped = (result <= Float(-1.0)) | (Float(1.0) <= result);
+					remapped = result <= Float(-1.0) ? Vec{} : remapped;
+					remapped = Float(1.0) <= result ? Vec{} + Float(1.0) : remapped;
+					remappedDx = clamped ? Vec{} : remappedDx;
+					remappedDy = clamped ? Vec{} : remappedDy;
+					__builtin_memcpy(out + i, &remapped, sizeof(Vec));
+					__builtin_memcpy(outDx + i, &remappedDx, sizeof(Vec));
+					__builtin_memcpy(outDy + i, &remappedDy, sizeof(Vec));
+				}
+				return i;
+			}
+		};
+
+		template <class Float>
+		using OctaveRowFunction = std::size_t (*)(const std::uint8_t*, const Float*, Float, std::size_t, Float*, std::int32_t, Float);
+
+		template <class Float, std::int32_t Octaves>
+		__attribute__((target("avx512f"), optimize("fp-contract=off")))
+		inline std::size_t OctaveRow_AVX512(const std::uint8_t* p, const Float* xs, const Float y, const std::size_t count, Float* out,
+			const std::int32_t octaves, const Float persistence) noexcept
+		{
+			return OctaveRowKernel<Float, 64>::template Run<Octaves>(p, xs, y, count, out, octaves, persistence);
+		}
+
+		template <class Float, std::int32_t Octaves>
+		__attribute__((target("avx2"), optimize("fp-contract=off")))
+		inline std::size_t OctaveRow_AVX2(const std::uint8_t* p, const Float* xs, const Float y, const std::size_t count, Float* out,
+			const std::int32_t octaves, const Float persistence) noexcept
+		{
+			return OctaveRowKernel<Float, 32>::template Run<Octaves>(p, xs, y, count, out, octaves, persistence);
+		}
+
+		template <class Float>
+		using OctaveRowDerivativesFunction = std::size_t (*)(const std::uint8_t*, const Float*, Float, std::size_t, Float*, Float*, Float*, std::int32_t, Float, Float);
+
+		template <class Float>
+		__attribute__((target("avx512f"), optimize("fp-contract=off")))
+		inline std::size_t OctaveRowDerivatives_AVX512(const std::uint8_t* p, const Float* xs, const Float y, const std::size_t count,
+			Float* out, Float* outDx, Float* outDy, const std::int32_t octaves, const Float persistence, const Float derivativeLimit) noexcept
+		{
+			return OctaveRowKernel<Float, 64>::RunDerivatives(p, xs, y, count, out, outDx, outDy, octaves, persistence, derivativeLimit);
+		}
+
+		template <class Float>
+		__attribute__((target("avx2"), optimize("fp-contract=off")))
+		inline std::size_t OctaveRowDerivatives_AVX2(const std::uint8_t* p, const Float* xs, const Float y, const std::size_t count,
+			Float* out, Float* outDx, Float* outDy, const std::int32_t octaves, const Float persistence, const Float derivativeLimit) noexcept
+		{
+			return OctaveRowKernel<Float, 32>::RunDerivatives(p, xs, y, count, out, outDx, outDy, octaves, persistence, derivativeLimit);
+		}
+
+		// Two SSE2 lanes lose to the scalar loop, where the per-lane hashing dominates, so older
+		// CPUs get nullptr and take that instead
+		template <class Function>
+		[[nodiscard]]
+		inline Function SelectKernel(const Function avx512, const Function avx2) noexcept
+		{
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f"))
+			{
+				return avx512;
+			}
+			if (__builtin_cpu_supports("avx2"))
+			{
+				return avx2;
+			}
+			return nullptr;
+		}
+
+		template <class Float, std::int32_t Octaves>
+		[[nodiscard]]
+		inline OctaveRowFunction<Float> SelectOctaveRow() noexcept
+		{
+			// Resolved once from CPUID
+			static const OctaveRowFunction<Float> function = SelectKernel<OctaveRowFunction<Float>>(
+				&OctaveRow_AVX512<Float, Octaves>, &OctaveRow_AVX2<Float, Octaves>);
+			return function;
+		}
+
+		template <class Float>
+		[[nodiscard]]
+		inline OctaveRowDerivativesFunction<Float> SelectOctaveRowDerivatives() noexcept
+		{
+			static const OctaveRowDerivativesFunction<Float> function = SelectKernel<OctaveRowDerivativesFunction<Float>>(
+				&OctaveRowDerivatives_AVX512<Float>, &OctaveRowDerivatives_AVX2<Float>);
+			return function;
+		}
+
+		# endif
+
 		template <class Float>
 		[[nodiscard]]
 		inline constexpr Float MaxAmplitude(const std::int32_t octaves, const Float persistence) noexcept
@@ -480,9 +1263,161 @@ namespace siv
 	template <class Float>
 	inline typename BasicPerlinNoise<Float>::value_type BasicPerlinNoise<Float>::noise2D(const value_type x, const value_type y) const noexcept
 	{
-		return noise3D(x,
-			y,
-			static_cast<value_type>(SIVPERLIN_DEFAULT_Z));
+	# ifdef SIVPERLIN_LATTICE_NOISE2D
+
+		return latticeNoise2D(x, y);
+
+	# else
+
+		const value_type _x = std::floor(x);
+		const value_type _y = std::floor(y);
+
+		const std::int32_t ix = static_cast<std::int32_t>(_x) & 255;
+		const std::int32_t iy = static_cast<std::int32_t>(_y) & 255;
+
+		const value_type fx = (x - _x);
+		const value_type fy = (y - _y);
+
+		const value_type u = perlin_detail::Fade(fx);
+		const value_type v = perlin_detail::Fade(fy);
+
+		const std::uint8_t A = (m_permutation[ix & 255] + iy) & 255;
+		const std::uint8_t B = (m_permutation[(ix + 1) & 255] + iy) & 255;
+
+		// noise3D() at the constant z = SIVPERLIN_DEFAULT_Z, with everything that only depends
+		// on z folded into constants. The result is bit-identical to noise3D(x, y, SIVPERLIN_DEFAULT_Z).
+		constexpr value_type z = static_cast<value_type>(SIVPERLIN_DEFAULT_Z);
+		const value_type _z = std::floor(z);
+		const std::int32_t iz = static_cast<std::int32_t>(_z) & 255;
+		const value_type fz = (z - _z);
+		const value_type w = perlin_detail::Fade(fz);
+
+		const std::uint8_t AA = (m_permutation[A] + iz) & 255;
+		const std::uint8_t AB = (m_permutation[(A + 1) & 255] + iz) & 255;
+
+		const std::uint8_t BA = (m_permutation[B] + iz) & 255;
+		const std::uint8_t BB = (m_permutation[(B + 1) & 255] + iz) & 255;
+
+		const value_type p0 = perlin_detail::Grad(m_permutation[AA], fx, fy, fz);
+		const value_type p1 = perlin_detail::Grad(m_permutation[BA], fx - 1, fy, fz);
+		const value_type p2 = perlin_detail::Grad(m_permutation[AB], fx, fy - 1, fz);
+		const value_type p3 = perlin_detail::Grad(m_permutation[BB], fx - 1, fy - 1, fz);
+		const value_type p4 = perlin_detail::Grad(m_permutation[(AA + 1) & 255], fx, fy, fz - 1);
+		const value_type p5 = perlin_detail::Grad(m_permutation[(BA + 1) & 255], fx - 1, fy, fz - 1);
+		const value_type p6 = perlin_detail::Grad(m_permutation[(AB + 1) & 255], fx, fy - 1, fz - 1);
+		const value_type p7 = perlin_detail::Grad(m_permutation[(BB + 1) & 255], fx - 1, fy - 1, fz - 1);
+
+		const value_type q0 = perlin_detail::Lerp(p0, p1, u);
+		const value_type q1 = perlin_detail::Lerp(p2, p3, u);
+		const value_type q2 = perlin_detail::Lerp(p4, p5, u);
+		const value_type q3 = perlin_detail::Lerp(p6, p7, u);
+
+		const value_type r0 = perlin_detail::Lerp(q0, q1, v);
+		const value_type r1 = perlin_detail::Lerp(q2, q3, v);
+
+		return perlin_detail::Lerp(r0, r1, w);
+
+	# endif
+	}
+
+	template <class Float>
+	inline typename BasicPerlinNoise<Float>::value_type BasicPerlinNoise<Float>::latticeNoise2D(const value_type x, const value_type y) const noexcept
+	{
+		const value_type _x = std::floor(x);
+		const value_type _y = std::floor(y);
+
+		const std::int32_t ix = static_cast<std::int32_t>(_x) & 255;
+		const std::int32_t iy = static_cast<std::int32_t>(_y) & 255;
+
+		const value_type fx = (x - _x);
+		const value_type fy = (y - _y);
+
+		const value_type u = perlin_detail::Fade(fx);
+		const value_type v = perlin_detail::Fade(fy);
+
+		const std::uint8_t A = (m_permutation[ix & 255] + iy) & 255;
+		const std::uint8_t B = (m_permutation[(ix + 1) & 255] + iy) & 255;
+
+		// On the z = 0 plane the far z layer has a weight of exactly 0, so it is skipped
+		const value_type p0 = perlin_detail::Grad(m_permutation[m_permutation[A]], fx, fy, value_type(0));
+		const value_type p1 = perlin_detail::Grad(m_permutation[m_permutation[B]], fx - 1, fy, value_type(0));
+		const value_type p2 = perlin_detail::Grad(m_permutation[m_permutation[(A + 1) & 255]], fx, fy - 1, value_type(0));
+		const value_type p3 = perlin_detail::Grad(m_permutation[m_permutation[(B + 1) & 255]], fx - 1, fy - 1, value_type(0));
+
+		const value_type q0 = perlin_detail::Lerp(p0, p1, u);
+		const value_type q1 = perlin_detail::Lerp(p2, p3, u);
+
+		return perlin_detail::Lerp(q0, q1, v);
+	}
+
+	template <class Float>
+	inline NoiseDerivatives<typename BasicPerlinNoise<Float>::value_type> BasicPerlinNoise<Float>::noise2DDerivatives(const value_type x, const value_type y) const noexcept
+	{
+		// noise2D() with every lerp carrying the derivatives along: a lerp by u or v also picks
+		// up the difference of its ends times Fade'
+		const value_type _x = std::floor(x);
+		const value_type _y = std::floor(y);
+
+		const std::int32_t ix = static_cast<std::int32_t>(_x) & 255;
+		const std::int32_t iy = static_cast<std::int32_t>(_y) & 255;
+
+		const value_type fx = (x - _x);
+		const value_type fy = (y - _y);
+
+		const value_type u = perlin_detail::Fade(fx);
+		const value_type v = perlin_detail::Fade(fy);
+		const value_type du = perlin_detail::FadeDerivative(fx);
+		const value_type dv = perlin_detail::FadeDerivative(fy);
+
+		const std::uint8_t A = (m_permutation[ix & 255] + iy) & 255;
+		const std::uint8_t B = (m_permutation[(ix + 1) & 255] + iy) & 255;
+
+	# ifdef SIVPERLIN_LATTICE_NOISE2D
+
+		const auto p0 = perlin_detail::GradDerivatives(m_permutation[m_permutation[A]], fx, fy, value_type(0));
+		const auto p1 = perlin_detail::GradDerivatives(m_permutation[m_permutation[B]], fx - 1, fy, value_type(0));
+		const auto p2 = perlin_detail::GradDerivatives(m_permutation[m_permutation[(A + 1) & 255]], fx, fy - 1, value_type(0));
+		const auto p3 = perlin_detail::GradDerivatives(m_permutation[m_permutation[(B + 1) & 255]], fx - 1, fy - 1, value_type(0));
+
+		const auto q0 = perlin_detail::LerpX(p0, p1, u, du);
+		const auto q1 = perlin_detail::LerpX(p2, p3, u, du);
+
+		return perlin_detail::LerpY(q0, q1, v, dv);
+
+	# else
+
+		constexpr value_type z = static_cast<value_type>(SIVPERLIN_DEFAULT_Z);
+		const value_type _z = std::floor(z);
+		const std::int32_t iz = static_cast<std::int32_t>(_z) & 255;
+		const value_type fz = (z - _z);
+		const value_type w = perlin_detail::Fade(fz);
+
+		const std::uint8_t AA = (m_permutation[A] + iz) & 255;
+		const std::uint8_t AB = (m_permutation[(A + 1) & 255] + iz) & 255;
+
+		const std::uint8_t BA = (m_permutation[B] + iz) & 255;
+		const std::uint8_t BB = (m_permutation[(B + 1) & 255] + iz) & 255;
+
+		const auto p0 = perlin_detail::GradDerivatives(m_permutation[AA], fx, fy, fz);
+		const auto p1 = perlin_detail::GradDerivatives(m_permutation[BA], fx - 1, fy, fz);
+		const auto p2 = perlin_detail::GradDerivatives(m_permutation[AB], fx, fy - 1, fz);
+		const auto p3 = perlin_detail::GradDerivatives(m_permutation[BB], fx - 1, fy - 1, fz);
+		const auto p4 = perlin_detail::GradDerivatives(m_permutation[(AA + 1) & 255], fx, fy, fz - 1);
+		const auto p5 = perlin_detail::GradDerivatives(m_permutation[(BA + 1) & 255], fx - 1, fy, fz - 1);
+		const auto p6 = perlin_detail::GradDerivatives(m_permutation[(AB + 1) & 255], fx, fy - 1, fz - 1);
+		const auto p7 = perlin_detail::GradDerivatives(m_permutation[(BB + 1) & 255], fx - 1, fy - 1, fz - 1);
+
+		const auto q0 = perlin_detail::LerpX(p0, p1, u, du);
+		const auto q1 = perlin_detail::LerpX(p2, p3, u, du);
+		const auto q2 = perlin_detail::LerpX(p4, p5, u, du);
+		const auto q3 = perlin_detail::LerpX(p6, p7, u, du);
+
+		const auto r0 = perlin_detail::LerpY(q0, q1, v, dv);
+		const auto r1 = perlin_detail::LerpY(q2, q3, v, dv);
+
+		return perlin_detail::LerpConstant(r0, r1, w);
+
+	# endif
 	}
 
 	template <class Float>
@@ -575,6 +1510,59 @@ namespace siv
 
 	///////////////////////////////////////
 
+	template <class Float>
+	template <std::int32_t Octaves>
+	inline typename BasicPerlinNoise<Float>::value_type BasicPerlinNoise<Float>::octave2D(const value_type x, const value_type y, const value_type persistence) const noexcept
+	{
+		static_assert(Octaves > 0);
+		constexpr std::size_t FixedOctaves = static_cast<std::size_t>(Octaves);
+		return perlin_detail::FixedOctave2D(*this, x, y, perlin_detail::OctaveAmplitudes<Float, FixedOctaves>(persistence), std::make_index_sequence<FixedOctaves>());
+	}
+
+	template <class Float>
+	template <std::int32_t Octaves>
+	inline typename BasicPerlinNoise<Float>::value_type BasicPerlinNoise<Float>::octave2D_01(const value_type x, const value_type y, const value_type persistence) const noexcept
+	{
+		return perlin_detail::RemapClamp_01(octave2D<Octaves>(x, y, persistence));
+	}
+
+	template <class Float>
+	inline typename BasicPerlinNoise<Float>::value_type BasicPerlinNoise<Float>::filteredOctave2D(const value_type x, const value_type y, const std::int32_t octaves, const value_type sampleSpacing,
+		const value_type persistence, const OctaveCutoff cutoff) const noexcept
+	{
+		return perlin_detail::FilteredOctave2D(*this, x, y, octaves, sampleSpacing, persistence, cutoff);
+	}
+
+	template <class Float>
+	inline typename BasicPerlinNoise<Float>::value_type BasicPerlinNoise<Float>::filteredOctave2D_01(const value_type x, const value_type y, const std::int32_t octaves, const value_type sampleSpacing,
+		const value_type persistence, const OctaveCutoff cutoff) const noexcept
+	{
+		return perlin_detail::RemapClamp_01(filteredOctave2D(x, y, octaves, sampleSpacing, persistence, cutoff));
+	}
+
+	template <class Float>
+	inline NoiseDerivatives<typename BasicPerlinNoise<Float>::value_type> BasicPerlinNoise<Float>::octave2DDerivatives(const value_type x, const value_type y, const std::int32_t octaves, const value_type persistence,
+		const value_type derivativeSpacing) const noexcept
+	{
+		return perlin_detail::Octave2DDerivatives(*this, x, y, octaves, persistence, derivativeSpacing);
+	}
+
+	template <class Float>
+	inline NoiseDerivatives<typename BasicPerlinNoise<Float>::value_type> BasicPerlinNoise<Float>::octave2D_01Derivatives(const value_type x, const value_type y, const std::int32_t octaves, const value_type persistence,
+		const value_type derivativeSpacing) const noexcept
+	{
+		const NoiseDerivatives<value_type> octave = octave2DDerivatives(x, y, octaves, persistence, derivativeSpacing);
+
+		if ((octave.value <= value_type(-1.0)) || (value_type(1.0) <= octave.value))
+		{
+			return{ perlin_detail::RemapClamp_01(octave.value), 0, 0 };
+		}
+
+		return{ perlin_detail::RemapClamp_01(octave.value), octave.dx * value_type(0.5), octave.dy * value_type(0.5) };
+	}
+
+	///////////////////////////////////////
+
 	template <class Float>
 	inline typename BasicPerlinNoise<Float>::value_type BasicPerlinNoise<Float>::octave1D_11(const value_type x, const std::int32_t octaves, const value_type persistence) const noexcept
 	{
@@ -615,6 +1603,74 @@ namespace siv
 
 	///////////////////////////////////////
 
+	template <class Float>
+	inline void BasicPerlinNoise<Float>::octave2D_01Row(const value_type* xs, const value_type y, const std::size_t count, value_type* out, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		std::size_t done = 0;
+	# ifdef SIVPERLIN_SIMD_X86
+		if (const auto function = perlin_detail::SelectOctaveRow<Float, 0>())
+		{
+			done = function(m_permutation.data(), xs, y, count, out, octaves, persistence);
+		}
+	# endif
+		for (std::size_t i = done; i < count; ++i)
+		{
+			out[i] = octave2D_01(xs[i], y, octaves, persistence);
+		}
+	}
+
+	template <class Float>
+	inline void BasicPerlinNoise<Float>::octave2D_01RowDerivatives(const value_type* xs, const value_type y, const std::size_t count, value_type* out,
+		value_type* outDx, value_type* outDy, const std::int32_t octaves, const value_type persistence, const value_type derivativeSpacing) const noexcept
+	{
+		std::size_t done = 0;
+	# ifdef SIVPERLIN_SIMD_X86
+		if (const auto function = perlin_detail::SelectOctaveRowDerivatives<Float>())
+		{
+			done = function(m_permutation.data(), xs, y, count, out, outDx, outDy, octaves, persistence,
+				perlin_detail::OctaveBandLimit(octaves, derivativeSpacing));
+		}
+	# endif
+		for (std::size_t i = done; i < count; ++i)
+		{
+			const NoiseDerivatives<value_type> sample = octave2D_01Derivatives(xs[i], y, octaves, persistence, derivativeSpacing);
+			out[i] = sample.value;
+			outDx[i] = sample.dx;
+			outDy[i] = sample.dy;
+		}
+	}
+
+	template <class Float>
+	template <std::int32_t Octaves>
+	inline void BasicPerlinNoise<Float>::octave2D_01Row(const value_type* xs, const value_type y, const std::size_t count, value_type* out, const value_type persistence) const noexcept
+	{
+		static_assert(Octaves > 0);
+		std::size_t done = 0;
+	# ifdef SIVPERLIN_SIMD_X86
+		if (const auto function = perlin_detail::SelectOctaveRow<Float, Octaves>())
+		{
+			done = function(m_permutation.data(), xs, y, count, out, Octaves, persistence);
+		}
+	# endif
+		for (std::size_t i = done; i < count; ++i)
+		{
+			out[i] = octave2D_01<Octaves>(xs[i], y, persistence);
+		}
+	}
+
+	template <class Float>
+	inline void BasicPerlinNoise<Float>::octave2D_01Row(const value_type x0, const value_type dx, const value_type y, const std::size_t count, value_type* out, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		// The positions go through out, which the kernels read ahead of writing
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			out[i] = x0 + static_cast<value_type>(i) * dx;
+		}
+		octave2D_01Row(out, y, count, out, octaves, persistence);
+	}
+
+	///////////////////////////////////////
+
 	template <class Float>
 	inline typename BasicPerlinNoise<Float>::value_type BasicPerlinNoise<Float>::normalizedOctave1D(const value_type x, const std::int32_t octaves, const value_type persistence) const noexcept
 	{
@@ -0,0 +1,113 @@
+//
+// Created by Lucas Wang on 2024-09-14.
+//
+
+#include "RtinMesher.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+
+bool RtinMesher::IsSupported(int gridSize) {
+    int quads = gridSize - 1;
+    return quads >= 2 && (quads & (quads - 1)) == 0;
+}
+
+const RtinMesher& RtinMesher::Get(int gridSize) {
+    static std::mutex mutex;
+    static std::map<int, std::unique_ptr<RtinMesher>> meshers;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& mesher = meshers[gridSize];
+    if (!mesher) {
+        mesher = std::make_unique<RtinMesher>(gridSize);
+    }
+    return *mesher;
+}
+
+RtinMesher::RtinMesher(int gridSize) :
+    m_gridSize(gridSize) {
+    const int tileSize = gridSize - 1;
+    m_triangleCount = tileSize * tileSize * 2 - 2;
+    m_parentCount = m_triangleCount - tileSize * tileSize;
+    m_coords.resize(static_cast<size_t>(m_triangleCount) * 4);
+
+    // Triangle i has the implicit id i + 2: ids 2 and 3 are the two halves of the grid, and the
+    // bits below the leading one pick the left or right half on the way down
+    for (int i = 0; i < m_triangleCount; ++i) {
+        int id = i + 2;
+        int ax = 0, ay = 0, bx = 0, by = 0, cx = 0, cy = 0;
+        if (id & 1) {
+            bx = by = cx = tileSize;
+        } else {
+            ax = ay = cy = tileSize;
+        }
+        while ((id >>= 1) > 1) {
+            int mx = (ax + bx) >> 1;
+            int my = (ay + by) >> 1;
+            if (id & 1) {
+                bx = ax;
+                by = ay;
+                ax = cx;
+                ay = cy;
+            } else {
+                ax = bx;
+                ay = by;
+                bx = cx;
+                by = cy;
+            }
+            cx = mx;
+            cy = my;
+        }
+        std::uint16_t* coords = &m_coords[static_cast<size_t>(i) * 4];
+        coords[0] = static_cast<std::uint16_t>(ax);
+        coords[1] = static_cast<std::uint16_t>(ay);
+        coords[2] = static_cast<std::uint16_t>(bx);
+        coords[3] = static_cast<std::uint16_t>(by);
+    }
+}
+
+void RtinMesher::ComputeErrors(const float* heights, int rowStride, std::vector<float>& errors) const {
+    errors.assign(static_cast<size_t>(m_gridSize) * m_gridSize, 0.0f);
+    auto height = [&](int x, int y) { return heights[y * rowStride + x]; };
+
+    // Children come after their parents, so walking backwards finishes every child before the
+    // parent folds its error in
+    for (int i = m_triangleCount - 1; i >= 0; --i) {
+        const std::uint16_t* coords = &m_coords[static_cast<size_t>(i) * 4];
+        int ax = coords[0], ay = coords[1], bx = coords[2], by = coords[3];
+        int mx = (ax + bx) >> 1;
+        int my = (ay + by) >> 1;
+        int cx = mx + my - ay;
+        int cy = my + ax - mx;
+
+        float interpolated = (height(ax, ay) + height(bx, by)) * 0.5f;
+        float& middleError = errors[my * m_gridSize + mx];
+        middleError = std::max(middleError, std::abs(interpolated - height(mx, my)));
+        if (i < m_parentCount) {
+            float leftError = errors[((ay + cy) >> 1) * m_gridSize + ((ax + cx) >> 1)];
+            float rightError = errors[((by + cy) >> 1) * m_gridSize + ((bx + cx) >> 1)];
+            middleError = std::max({ middleError, leftError, rightError });
+        }
+    }
+}
+
+void RtinMesher::Extract(const std::vector<float>& errors, float maxError, std::vector<unsigned int>& indices) const {
+    const int max = m_gridSize - 1;
+    extractTriangle(0, 0, max, max, max, 0, errors, maxError, indices);
+    extractTriangle(max, max, 0, 0, 0, max, errors, maxError, indices);
+}
+
+void RtinMesher::extractTriangle(int ax, int ay, int bx, int by, int cx, int cy, const std::vector<float>& errors,
+                                 float maxError, std::vector<unsigned int>& indices) const {
+    int mx = (ax + bx) >> 1;
+    int my = (ay + by) >> 1;
+    if (std::abs(ax - cx) + std::abs(ay - cy) > 1 && errors[my * m_gridSize + mx] > maxError) {
+        extractTriangle(cx, cy, ax, ay, mx, my, errors, maxError, indices);
+        extractTriangle(bx, by, cx, cy, mx, my, errors, maxError, indices);
+        return;
+    }
+    indices.push_back(static_cast<unsigned int>(ay * m_gridSize + ax));
+    indices.push_back(static_cast<unsigned int>(by * m_gridSize + bx));
+    indices.push_back(static_cast<unsigned int>(cy * m_gridSize + cx));
+}
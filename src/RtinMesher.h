@@ -0,0 +1,44 @@
+//
+// Created by Lucas Wang on 2024-09-14.
+//
+
+#ifndef TERRAINRENDERING_RTINMESHER_H
+#define TERRAINRENDERING_RTINMESHER_H
+
+#include <cstdint>
+#include <vector>
+
+// Right-triangulated irregular network over a (2^k + 1) x (2^k + 1) height grid: the grid is
+// split into two right triangles, and each triangle recursively into two halves through the
+// midpoint of its hypotenuse. The error of every vertex is measured once per heightfield; a
+// mesh for any error threshold is then read out in time linear in its triangle count, as
+// indices into the unchanged grid. Pure CPU code, it does not need a GL context.
+class RtinMesher {
+public:
+    static bool IsSupported(int gridSize);
+    // Shared per grid size and safe to call from worker threads
+    static const RtinMesher& Get(int gridSize);
+
+    explicit RtinMesher(int gridSize);
+
+    // heights is row-major with rowStride floats between rows; errors receives one value per
+    // grid vertex, the height error of skipping it and every vertex below it in the hierarchy
+    void ComputeErrors(const float* heights, int rowStride, std::vector<float>& errors) const;
+    // Appends the triangles of the coarsest mesh whose skipped vertices all have an error of
+    // at most maxError
+    void Extract(const std::vector<float>& errors, float maxError, std::vector<unsigned int>& indices) const;
+
+private:
+    int m_gridSize;
+    int m_triangleCount;
+    // Triangles that have children; they come first in the hierarchy order
+    int m_parentCount;
+    // Corners a and b of the hypotenuse of every triangle in the hierarchy, as x, y pairs
+    std::vector<std::uint16_t> m_coords;
+
+    void extractTriangle(int ax, int ay, int bx, int by, int cx, int cy, const std::vector<float>& errors,
+                         float maxError, std::vector<unsigned int>& indices) const;
+};
+
+
+#endif //TERRAINRENDERING_RTINMESHER_H
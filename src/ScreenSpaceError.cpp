@@ -0,0 +1,66 @@
+//
+// Created by Lucas Wang on 2024-09-10.
+//
+
+#include "ScreenSpaceError.h"
+#include <algorithm>
+#include <cmath>
+#include "TaskScheduler.h"
+
+ScreenSpaceError::ScreenSpaceError(float viewportHeight, float fovY, float maxPixelError) :
+    m_pixelsPerUnit(viewportHeight / (2.0f * std::tan(fovY * 0.5f))),
+    m_maxPixelError(maxPixelError) {
+}
+
+float ScreenSpaceError::Project(float geometricError, float distance) const {
+    // Clamped so that a camera inside the bounds does not divide by zero
+    return geometricError * m_pixelsPerUnit / std::max(distance, 1e-3f);
+}
+
+int ScreenSpaceError::SelectLevel(const std::vector<float>& levelErrors, float distance) const {
+    int level = 0;
+    while (level + 1 < static_cast<int>(levelErrors.size()) && Project(levelErrors[level + 1], distance) <= m_maxPixelError) {
+        ++level;
+    }
+    return level;
+}
+
+float ScreenSpaceError::Distance(const AABB& box, const glm::vec3& point) {
+    return glm::length(point - glm::clamp(point, box.Min, box.Max));
+}
+
+void ScreenSpaceError::ComputeLevelErrors(const float* heights, int width, int depth, int levels, std::vector<float>& errors) {
+    // A grid vertex that a mip level skips is drawn at the height of the level's triangle above
+    // it. The triangles split each cell along the top-right to bottom-left diagonal, as in
+    // BuildTriangleList, so the interpolation has to follow the same split.
+    errors.assign(levels, 0.0f);
+    std::vector<float> rowErrors(depth);
+    auto height = [&](int x, int z) { return heights[z * width + x]; };
+
+    for (int level = 1; level < levels; ++level) {
+        const int step = 1 << level;
+        TaskScheduler::Instance().ParallelFor(0, depth, 8, [&](int start, int end) {
+            for (int z = start; z < end; ++z) {
+                int cellZ = std::min(z / step * step, depth - 1 - step);
+                float v = static_cast<float>(z - cellZ) / step;
+                float rowError = 0.0f;
+                for (int x = 0; x < width; ++x) {
+                    int cellX = std::min(x / step * step, width - 1 - step);
+                    float u = static_cast<float>(x - cellX) / step;
+                    float topLeft = height(cellX, cellZ);
+                    float topRight = height(cellX + step, cellZ);
+                    float bottomLeft = height(cellX, cellZ + step);
+                    float bottomRight = height(cellX + step, cellZ + step);
+                    float coarse = u + v <= 1.0f
+                        ? topLeft + u * (topRight - topLeft) + v * (bottomLeft - topLeft)
+                        : bottomRight + (1.0f - u) * (bottomLeft - bottomRight) + (1.0f - v) * (topRight - bottomRight);
+                    rowError = std::max(rowError, std::abs(height(x, z) - coarse));
+                }
+                rowErrors[z] = rowError;
+            }
+        });
+        // A coarser level never counts as more accurate than a finer one
+        float levelError = *std::max_element(rowErrors.begin(), rowErrors.end());
+        errors[level] = std::max(levelError, errors[level - 1]);
+    }
+}
@@ -0,0 +1,39 @@
+//
+// Created by Lucas Wang on 2024-09-10.
+//
+
+#ifndef TERRAINRENDERING_SCREENSPACEERROR_H
+#define TERRAINRENDERING_SCREENSPACEERROR_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "Frustum.h"
+
+// Picks how coarse a mesh can be drawn from how many pixels its geometric error covers on screen.
+// Pure CPU code, it does not need a GL context.
+class ScreenSpaceError {
+public:
+    // fovY in radians. Levels whose projected error exceeds maxPixelError are not used.
+    ScreenSpaceError(float viewportHeight, float fovY, float maxPixelError);
+
+    // Pixels covered by geometricError world units seen from distance world units away
+    float Project(float geometricError, float distance) const;
+    // Index of the coarsest level within the pixel budget. levelErrors is finest first, starts
+    // at 0 and never decreases.
+    int SelectLevel(const std::vector<float>& levelErrors, float distance) const;
+
+    // 0 when the point is inside the box
+    static float Distance(const AABB& box, const glm::vec3& point);
+    // Geometric error of each mip level of a row-major width x depth height grid, finest first:
+    // the largest height difference between the full grid and the level sampling every
+    // (1 << level)th vertex. Level 0 is exact, and no level is reported below a finer one.
+    static void ComputeLevelErrors(const float* heights, int width, int depth, int levels, std::vector<float>& errors);
+
+private:
+    // viewportHeight / (2 tan(fovY / 2)), the projection scale at unit distance
+    float m_pixelsPerUnit;
+    float m_maxPixelError;
+};
+
+
+#endif //TERRAINRENDERING_SCREENSPACEERROR_H
@@ -0,0 +1,143 @@
+//
+// Created by Lucas Wang on 2024-08-12.
+//
+
+#include "TaskScheduler.h"
+#include <algorithm>
+
+namespace {
+    // Index of the worker running on this thread, or -1 outside the pool
+    thread_local int t_workerIndex = -1;
+    thread_local const TaskScheduler* t_scheduler = nullptr;
+}
+
+TaskScheduler& TaskScheduler::Instance() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+TaskScheduler::TaskScheduler(unsigned int numThreads)
+        : m_numWorkers(numThreads > 0 ? numThreads : std::max(1u, std::thread::hardware_concurrency())) {
+    // Workers start stealing right away, so every queue must exist before the first one runs
+    for (unsigned int i = 0; i <= m_numWorkers; ++i) {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (unsigned int i = 0; i < m_numWorkers; ++i) {
+        m_threads.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void TaskScheduler::Submit(std::function<void()> task) {
+    bool onWorker = t_scheduler == this && t_workerIndex >= 0;
+    WorkQueue& queue = onWorker ? *m_queues[t_workerIndex] : *m_queues.back();
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        ++m_queuedTasks;
+    }
+    m_wake.notify_one();
+}
+
+void TaskScheduler::ParallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& body) {
+    if (begin >= end) {
+        return;
+    }
+    grainSize = std::max(1, grainSize);
+    int numRanges = (end - begin + grainSize - 1) / grainSize;
+
+    struct RangeState {
+        std::atomic<int> next{ 0 };
+        std::atomic<int> done{ 0 };
+    };
+    auto state = std::make_shared<RangeState>();
+
+    // A helper that starts after every range is claimed exits without touching body,
+    // so it is fine for it to outlive this call
+    auto runRanges = [state, begin, end, grainSize, numRanges, &body]() {
+        int range;
+        while ((range = state->next.fetch_add(1)) < numRanges) {
+            int rangeBegin = begin + range * grainSize;
+            body(rangeBegin, std::min(end, rangeBegin + grainSize));
+            state->done.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    int numHelpers = std::min<int>(numRanges - 1, static_cast<int>(m_numWorkers));
+    for (int i = 0; i < numHelpers; ++i) {
+        Submit(runRanges);
+    }
+    runRanges();
+
+    // Every range is claimed by now; wait for the ones still running on other threads
+    while (state->done.load(std::memory_order_acquire) < numRanges) {
+        std::this_thread::yield();
+    }
+}
+
+unsigned int TaskScheduler::GetThreadCount() const {
+    return m_numWorkers;
+}
+
+void TaskScheduler::WorkerLoop(unsigned int index) {
+    t_workerIndex = static_cast<int>(index);
+    t_scheduler = this;
+    while (true) {
+        if (TryRunTask(index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this] { return m_stopping || m_queuedTasks.load() > 0; });
+        if (m_stopping) {
+            return;
+        }
+    }
+}
+
+bool TaskScheduler::TryRunTask(unsigned int index) {
+    std::function<void()> task;
+    // Own work first (most recent, still hot in cache), then outside submissions, then steal
+    bool found = PopBack(*m_queues[index], task) || PopFront(*m_queues.back(), task);
+    for (unsigned int i = 1; !found && i < m_numWorkers; ++i) {
+        found = PopFront(*m_queues[(index + i) % m_numWorkers], task);
+    }
+    if (!found) {
+        return false;
+    }
+    --m_queuedTasks;
+    task();
+    return true;
+}
+
+bool TaskScheduler::PopBack(WorkQueue& queue, std::function<void()>& task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool TaskScheduler::PopFront(WorkQueue& queue, std::function<void()>& task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
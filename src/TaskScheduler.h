@@ -0,0 +1,61 @@
+//
+// Created by Lucas Wang on 2024-08-12.
+//
+
+#ifndef TERRAINRENDERING_TASKSCHEDULER_H
+#define TERRAINRENDERING_TASKSCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Process-wide work-stealing scheduler shared by chunk generation and the per-chunk passes.
+// Each worker owns a deque it pushes to and pops from at the back; idle workers steal from
+// the front of the others. Tasks submitted from threads outside the pool go to a shared queue.
+class TaskScheduler {
+public:
+    static TaskScheduler& Instance();
+
+    explicit TaskScheduler(unsigned int numThreads = 0);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    void Submit(std::function<void()> task);
+
+    // Runs body(rangeBegin, rangeEnd) over [begin, end) in ranges of grainSize. Ranges are
+    // claimed dynamically so uneven work balances itself, and the calling thread takes part,
+    // which makes it safe to call from inside a task.
+    void ParallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& body);
+
+    unsigned int GetThreadCount() const;
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    unsigned int m_numWorkers;
+    std::vector<std::thread> m_threads;
+    // One queue per worker, followed by the shared queue for outside submissions
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<int> m_queuedTasks{ 0 };
+    bool m_stopping = false;
+
+    void WorkerLoop(unsigned int index);
+    bool TryRunTask(unsigned int index);
+    bool PopBack(WorkQueue& queue, std::function<void()>& task);
+    bool PopFront(WorkQueue& queue, std::function<void()>& task);
+};
+
+
+#endif //TERRAINRENDERING_TASKSCHEDULER_H
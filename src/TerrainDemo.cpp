@@ -8,6 +8,8 @@
 #include "imgui/backends/imgui_impl_opengl3.h"
 #include <string>
 #include "Skybox.h"
+#include "ChunkBufferPool.h"
+#include "ChunkDrawBatch.h"
 
 static void ResizeCallback(GLFWwindow*, int, int);
 static void MouseMoveCallback(GLFWwindow*, double, double);
@@ -38,15 +40,23 @@ void TerrainDemo::Init() {
 
 void TerrainDemo::CreateWindow() {
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    m_window = NULL;
+#else
+    // 4.6 allows drawing all chunks with one multi-draw-indirect call
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    m_window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "TerrainRendering", NULL, NULL);
 #endif
 
-    m_window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "TerrainRendering", NULL, NULL);
+    if (m_window == NULL) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+        m_window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "TerrainRendering", NULL, NULL);
+    }
     if (m_window == NULL)
     {
         std::cout << "Failed to create GLFW window" << std::endl;
@@ -60,6 +70,8 @@ void TerrainDemo::CreateWindow() {
         std::cout << "Failed to initialize GLAD" << std::endl;
         exit(0);
     }
+    ChunkDrawBatch::LoadFunctions((GLADloadproc)glfwGetProcAddress);
+    ChunkStagingRing::LoadFunctions((GLADloadproc)glfwGetProcAddress);
 
     glEnable(GL_DEPTH_TEST);
     //glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
@@ -74,7 +86,14 @@ void TerrainDemo::InitImGui() {
 }
 
 void TerrainDemo::InitTerrain() {
-    m_terrain = new InfiniteTerrain(256, 20.0f);
+    // 257 samples give 256 quads a side, which the LOD quadtree splits into 32-quad nodes
+    m_terrain = new InfiniteTerrain(257, 20.0f);
+    const std::vector<unsigned int>& rowMajor = IndexBufferRegistry::GetTriangleList(257, 257);
+    const std::vector<unsigned int>& optimized = IndexBufferRegistry::GetOptimizedTriangleList(257, 257);
+    m_rowMajorCacheStats = VertexCacheOptimizer::Simulate(rowMajor.data(), rowMajor.size(), 257 * 257, 32);
+    m_optimizedCacheStats = VertexCacheOptimizer::Simulate(optimized.data(), optimized.size(), 257 * 257, 32);
+    m_terrain->SetIndirectShader(m_indirectShader);
+    m_clipmap = new ClipmapTerrain(20.0f);
 }
 
 void TerrainDemo::SetCallbacks() {
@@ -88,6 +107,10 @@ void TerrainDemo::SetCallbacks() {
 void TerrainDemo::CreateShaders() {
     m_shader = new Shader("resources/shaders/terrain.vs", "resources/shaders/terrain.fs");
     m_skyboxShader = new Shader("resources/shaders/skybox.vs", "resources/shaders/skybox.fs");
+    m_clipmapShader = new Shader("resources/shaders/clipmap.vs", "resources/shaders/terrain.fs");
+    if (ChunkDrawBatch::IsSupported()) {
+        m_indirectShader = new Shader("resources/shaders/terrain_indirect.vs", "resources/shaders/terrain.fs");
+    }
 }
 
 void TerrainDemo::CreateCamera() {
@@ -105,6 +128,13 @@ void TerrainDemo::Run() {
         glfwSwapBuffers(m_window);
         glfwPollEvents();
     }
+    // Chunk buffers go back to the pool on deletion and are freed while the context is still alive
+    delete m_terrain;
+    m_terrain = nullptr;
+    delete m_clipmap;
+    m_clipmap = nullptr;
+    ChunkBufferPool::Clear();
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -121,15 +151,35 @@ void TerrainDemo::Render() {
     // view/projection transformations
     glm::mat4 projection = glm::perspective(glm::radians(m_camera->Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
     glm::mat4 view = m_camera->GetViewMatrix();
+    glm::mat4 model = glm::mat4(1.0f);
+    if (m_indirectShader) {
+        m_indirectShader->use();
+        m_indirectShader->setMat4("projection", projection);
+        m_indirectShader->setMat4("view", view);
+        m_indirectShader->setMat4("model", model);
+        m_indirectShader->setVec3("cameraPos", m_camera->Position);
+    }
     m_shader->use();
     m_shader->setMat4("projection", projection);
     m_shader->setMat4("view", view);
-    glm::mat4 model = glm::mat4(1.0f);
     m_shader->setMat4("model", model);
-
-    m_terrain->updateChunks(m_camera->Position.x, m_camera->Position.z);
-    m_terrain->renderTerrain();
-    m_terrain->cleanupChunks(m_camera->Position.x, m_camera->Position.z);
+    m_shader->setVec3("cameraPos", m_camera->Position);
+
+    if (m_useClipmap) {
+        m_clipmapShader->use();
+        m_clipmapShader->setMat4("projection", projection);
+        m_clipmapShader->setMat4("view", view);
+        m_clipmapShader->setMat4("model", model);
+        m_clipmap->updateLevels(m_camera->Position.x, m_camera->Position.z);
+        m_clipmap->renderTerrain(*m_clipmapShader, m_camera->Position);
+    } else {
+        m_terrain->SetLodMode(m_lodMode);
+        m_terrain->SetVertexFormat(m_vertexFormat);
+        m_terrain->SetScreenSpaceError((float)SCR_HEIGHT, glm::radians(m_camera->Zoom), 2.0f);
+        m_terrain->updateChunks(m_camera->Position.x, m_camera->Position.z);
+        m_terrain->renderTerrain(*m_shader, projection * view, m_camera->Position);
+        m_terrain->cleanupChunks(m_camera->Position.x, m_camera->Position.z);
+    }
 
     m_skyboxShader->use();
     view = glm::mat4(glm::mat3(m_camera->GetViewMatrix())); // remove translation from the view matrix
@@ -139,7 +189,23 @@ void TerrainDemo::Render() {
     m_skybox->RenderSkybox();
 
     ImGui::Begin("ImGui Window");
-    ImGui::Text("Hello ImGui");
+    if (m_useClipmap) {
+        ImGui::Text("Clipmap levels: %d x %d, vertices: %zu, updated: %zu (C for chunks)", m_clipmap->GetLevelCount(),
+                    m_clipmap->GetRingSize(), m_clipmap->GetVertexCount(), m_clipmap->GetUpdatedVertexCount());
+    } else {
+        ImGui::Text("Chunks drawn: %d, culled: %d, draw calls: %d", m_terrain->GetVisibleChunkCount(),
+                    m_terrain->GetCulledChunkCount(), m_terrain->GetDrawCallCount());
+        const char* lodModeName = m_lodMode == ChunkLodMode::Quadtree ? "CDLOD"
+                                : m_lodMode == ChunkLodMode::ScreenSpaceError ? "screen-space error" : "adaptive";
+        ImGui::Text("Triangles: %zu, new chunks use %s (L to switch)", m_terrain->GetTriangleCount(), lodModeName);
+        ImGui::Text("New chunks store %s (V to switch)",
+                    m_vertexFormat == VertexFormat::HeightTexture ? "height textures" : "compact vertices");
+        ChunkBufferPoolStats poolStats = ChunkBufferPool::GetStats();
+        ImGui::Text("Chunk buffers in use: %zu, free: %zu, peak: %zu, created: %zu",
+                    poolStats.InUse, poolStats.Free, poolStats.HighWater, poolStats.Created);
+        ImGui::Text("Chunk grid ACMR: %.2f row-major, %.2f optimized (32-entry FIFO)",
+                    m_rowMajorCacheStats.ACMR, m_optimizedCacheStats.ACMR);
+    }
     ImGui::End();
 
     ImGui::Render();
@@ -183,6 +249,19 @@ static void KeyPressedCallback(GLFWwindow *w, int key, int scancode,
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
         glfwSetWindowShouldClose(w, true);
     }
+    if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+        app->m_useClipmap = !app->m_useClipmap;
+    }
+    if (key == GLFW_KEY_V && action == GLFW_PRESS) {
+        app->m_vertexFormat = app->m_vertexFormat == VertexFormat::Compact ? VertexFormat::HeightTexture : VertexFormat::Compact;
+    }
+    if (key == GLFW_KEY_L && action == GLFW_PRESS) {
+        switch (app->m_lodMode) {
+            case ChunkLodMode::Quadtree: app->m_lodMode = ChunkLodMode::ScreenSpaceError; break;
+            case ChunkLodMode::ScreenSpaceError: app->m_lodMode = ChunkLodMode::Adaptive; break;
+            default: app->m_lodMode = ChunkLodMode::Quadtree; break;
+        }
+    }
     if (action == GLFW_PRESS || action == GLFW_REPEAT) {
         app->m_keys[key] = true;
     }
@@ -215,14 +294,19 @@ void TerrainDemo::OnMouseMove(GLFWwindow* window, double x, double y) {
 }
 
 void TerrainDemo::SetShaderUniforms() {
-    m_shader->use();
-    m_shader->setVec3("lightPos", glm::vec3(10000.0f, 10.0f, 0.0f));
-    m_shader->setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
-
-    m_shader->setInt("diffuseMap", 0);
-    m_shader->setInt("dispMap", 1);
-    m_shader->setInt("normalMap", 2);
-    m_shader->setInt("roughMap", 3);
+    for (Shader* shader : { m_shader, m_indirectShader, m_clipmapShader }) {
+        if (!shader) {
+            continue;
+        }
+        shader->use();
+        shader->setVec3("lightPos", glm::vec3(10000.0f, 10.0f, 0.0f));
+        shader->setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
+
+        shader->setInt("diffuseMap", 0);
+        shader->setInt("dispMap", 1);
+        shader->setInt("normalMap", 2);
+        shader->setInt("roughMap", 3);
+    }
 }
 
 void TerrainDemo::InitSkybox() {
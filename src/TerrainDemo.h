@@ -14,6 +14,8 @@
 #include "Skybox.h"
 #include <iostream>
 #include "InfiniteTerrain.h"
+#include "ClipmapTerrain.h"
+#include "VertexCacheOptimizer.h"
 
 
 class TerrainDemo {
@@ -35,14 +37,28 @@ public:
     float m_lastY;
 
     int m_keys[1024] = { false };
+    // Toggled with C: geometry clipmap instead of streamed chunks
+    bool m_useClipmap = false;
+    // Cycled with L through CDLOD, screen-space error mip levels and adaptive meshes, for chunks
+    // loaded afterwards
+    ChunkLodMode m_lodMode = ChunkLodMode::Quadtree;
+    // Toggled with V between compact vertices and height textures, for chunks loaded afterwards
+    VertexFormat m_vertexFormat = VertexFormat::Compact;
 
 private:
     GLFWwindow *m_window;
     Camera *m_camera;
     Shader *m_shader;
     Shader *m_skyboxShader;
+    // Only created when the context supports multi-draw-indirect
+    Shader *m_indirectShader = nullptr;
+    Shader *m_clipmapShader;
     InfiniteTerrain *m_terrain;
+    ClipmapTerrain *m_clipmap;
     Skybox *m_skybox;
+    // Simulated vertex cache behaviour of the chunk grid before and after reordering
+    VertexCacheStats m_rowMajorCacheStats;
+    VertexCacheStats m_optimizedCacheStats;
 
     void CreateWindow();
     void CreateShaders();
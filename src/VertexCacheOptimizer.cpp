@@ -0,0 +1,148 @@
+//
+// Created by Lucas Wang on 2024-09-17.
+//
+
+#include "VertexCacheOptimizer.h"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+template <typename T>
+void VertexCacheOptimizer::Optimize(T* indices, std::size_t count, std::size_t vertexCount, int cacheSize) {
+    const std::size_t triangleCount = count / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Triangles around each vertex, in compressed rows
+    std::vector<int> liveTriangles(vertexCount, 0);
+    for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+        ++liveTriangles[indices[i]];
+    }
+    std::vector<std::size_t> adjacencyStart(vertexCount + 1, 0);
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        adjacencyStart[v + 1] = adjacencyStart[v] + liveTriangles[v];
+    }
+    std::vector<std::size_t> adjacency(triangleCount * 3);
+    std::vector<std::size_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        for (int corner = 0; corner < 3; ++corner) {
+            adjacency[fill[indices[t * 3 + corner]]++] = t;
+        }
+    }
+
+    // Time each vertex last entered the cache; a vertex is still cached while
+    // timestamp - cacheTime[v] <= cacheSize
+    std::vector<std::int64_t> cacheTime(vertexCount, 0);
+    std::int64_t timestamp = cacheSize + 1;
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<T> deadEnds;
+    std::vector<T> candidates;
+    std::vector<T> output;
+    output.reserve(triangleCount * 3);
+    std::size_t cursor = 0;
+
+    auto skipDeadEnd = [&]() -> std::int64_t {
+        while (!deadEnds.empty()) {
+            T vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[vertex] > 0) {
+                return vertex;
+            }
+        }
+        for (; cursor < vertexCount; ++cursor) {
+            if (liveTriangles[cursor] > 0) {
+                return static_cast<std::int64_t>(cursor);
+            }
+        }
+        return -1;
+    };
+
+    std::int64_t fan = skipDeadEnd();
+    while (fan >= 0) {
+        // Emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (std::size_t a = adjacencyStart[fan]; a < adjacencyStart[fan + 1]; ++a) {
+            std::size_t t = adjacency[a];
+            if (emitted[t]) {
+                continue;
+            }
+            emitted[t] = true;
+            for (int corner = 0; corner < 3; ++corner) {
+                T vertex = indices[t * 3 + corner];
+                output.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                --liveTriangles[vertex];
+                if (timestamp - cacheTime[vertex] > cacheSize) {
+                    cacheTime[vertex] = timestamp++;
+                }
+            }
+        }
+
+        // Continue from the candidate that will still be cached after its remaining triangles
+        // are emitted and has been in the cache longest
+        std::int64_t next = -1;
+        std::int64_t bestPriority = -1;
+        for (T vertex : candidates) {
+            if (liveTriangles[vertex] <= 0) {
+                continue;
+            }
+            std::int64_t priority = 0;
+            if (timestamp - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize) {
+                priority = timestamp - cacheTime[vertex];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = vertex;
+            }
+        }
+        fan = next >= 0 ? next : skipDeadEnd();
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+template <typename T>
+VertexCacheStats VertexCacheOptimizer::Simulate(const T* indices, std::size_t count, std::size_t vertexCount, int cacheSize,
+                                                VertexCachePolicy policy) {
+    VertexCacheStats stats;
+    if (count < 3) {
+        return stats;
+    }
+
+    std::deque<T> cache;
+    std::vector<bool> referenced(vertexCount, false);
+    std::size_t misses = 0;
+    std::size_t distinct = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        T vertex = indices[i];
+        if (!referenced[vertex]) {
+            referenced[vertex] = true;
+            ++distinct;
+        }
+        auto hit = std::find(cache.begin(), cache.end(), vertex);
+        if (hit != cache.end()) {
+            if (policy == VertexCachePolicy::LRU) {
+                cache.erase(hit);
+                cache.push_front(vertex);
+            }
+            continue;
+        }
+        ++misses;
+        cache.push_front(vertex);
+        if (cache.size() > static_cast<std::size_t>(cacheSize)) {
+            cache.pop_back();
+        }
+    }
+
+    stats.ACMR = static_cast<float>(misses) / static_cast<float>(count / 3);
+    stats.ATVR = static_cast<float>(misses) / static_cast<float>(distinct);
+    return stats;
+}
+
+template void VertexCacheOptimizer::Optimize<std::uint16_t>(std::uint16_t*, std::size_t, std::size_t, int);
+template void VertexCacheOptimizer::Optimize<std::uint32_t>(std::uint32_t*, std::size_t, std::size_t, int);
+template VertexCacheStats VertexCacheOptimizer::Simulate<std::uint16_t>(const std::uint16_t*, std::size_t, std::size_t, int, VertexCachePolicy);
+template VertexCacheStats VertexCacheOptimizer::Simulate<std::uint32_t>(const std::uint32_t*, std::size_t, std::size_t, int, VertexCachePolicy);
@@ -0,0 +1,40 @@
+//
+// Created by Lucas Wang on 2024-09-17.
+//
+
+#ifndef TERRAINRENDERING_VERTEXCACHEOPTIMIZER_H
+#define TERRAINRENDERING_VERTEXCACHEOPTIMIZER_H
+
+#include <cstddef>
+
+enum class VertexCachePolicy {
+    FIFO,
+    LRU
+};
+
+struct VertexCacheStats {
+    // Cache misses per triangle: 0.5 is the limit for a large regular grid, 3 means no reuse
+    float ACMR = 0.0f;
+    // Cache misses per distinct vertex referenced, 1 at best
+    float ATVR = 0.0f;
+};
+
+// Orders triangle lists for the post-transform vertex cache and measures the result on a
+// simulated cache, so the effect of an ordering can be checked without a GPU.
+// Pure CPU code, it does not need a GL context.
+class VertexCacheOptimizer {
+public:
+    static constexpr int kDefaultCacheSize = 16;
+
+    // Reorders the triangles of a list in place with Tipsify (Sander et al. 2007). Triangles keep
+    // their winding, only the order they are drawn in changes. Every index must be below vertexCount.
+    template <typename T>
+    static void Optimize(T* indices, std::size_t count, std::size_t vertexCount, int cacheSize = kDefaultCacheSize);
+
+    template <typename T>
+    static VertexCacheStats Simulate(const T* indices, std::size_t count, std::size_t vertexCount, int cacheSize,
+                                     VertexCachePolicy policy = VertexCachePolicy::FIFO);
+};
+
+
+#endif //TERRAINRENDERING_VERTEXCACHEOPTIMIZER_H
@@ -4,72 +4,435 @@
 
 #include "terrain.h"
 #include <iostream>
-#include <thread>
+#include <algorithm>
+#include <cmath>
+#include "TaskScheduler.h"
+#include "ChunkBufferPool.h"
+#include "ChunkDrawBatch.h"
+#include "RtinMesher.h"
+#include "VertexCacheOptimizer.h"
+#include "ScreenSpaceError.h"
+#include <cstring>
+#include <bit>
 
 Terrain::Terrain(int width, int depth, bool perlinNoise)
         : m_width(width), m_depth(depth), m_perlinNoise(perlinNoise) {
 
 }
 
-Terrain::Terrain(int x, int z, int chunkSize, float terrainScale) :
+// Texture unit the height texture array of HeightTexture chunks is bound to
+static const int kHeightTextureUnit = 5;
+
+// Octahedral encoding around +Y, the up axis of the heightfield
+static glm::vec2 OctEncode(glm::vec3 n) {
+    n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    glm::vec2 e(n.x, n.z);
+    if (n.y < 0.0f) {
+        glm::vec2 signs(e.x >= 0.0f ? 1.0f : -1.0f, e.y >= 0.0f ? 1.0f : -1.0f);
+        e = (1.0f - glm::abs(glm::vec2(e.y, e.x))) * signs;
+    }
+    return e;
+}
+
+Terrain::Terrain(int x, int z, int chunkSize, float terrainScale, IndexTopology topology, VertexFormat vertexFormat) :
     chunkX(x),
     chunkZ(z),
     m_width(chunkSize),
     m_depth(chunkSize),
-    m_terrainScale(terrainScale){
+    m_terrainScale(terrainScale),
+    m_topology(topology),
+    m_vertexFormat(vertexFormat){
     m_perlinNoise = true;
 }
 
+Terrain::~Terrain() {
+    if (m_heightLayer.Page >= 0) {
+        m_heightTextures->Free(m_heightLayer);
+    }
+    if (m_stagedSize > 0) {
+        m_stagingRing->Release(m_stagingRegion);
+    }
+    if (m_batchSlot >= 0) {
+        m_drawBatch->Free(m_batchSlot);
+    }
+    if (m_VAO != 0) {
+        ChunkBufferPool::Release(m_vertexFormat, m_width, m_depth, m_topology, ChunkBufferSlot{ m_VAO, m_VBO, m_VBOSize, m_EBO, m_EBOSize });
+    }
+}
+
 void Terrain::Generate() {
-    InitGLStates();
+    BuildMesh();
+    Upload();
+}
+
+void Terrain::BuildMesh() {
     InitHeightMap();
-    PopulateBuffer();
-    UnbindBuffers();
+    if (m_vertexFormat == VertexFormat::HeightTexture) {
+        InitHaloHeights();
+        if (m_topology == IndexTopology::Adaptive) {
+            BuildAdaptiveIndices(&m_haloHeights[m_width + 3], m_width + 2);
+        }
+        PackHeightTexels();
+        std::vector<float>().swap(m_haloHeights);
+        return;
+    }
+    if (!m_perlinNoise) {
+        // Heightmap terrains only use the Standard layout over the plain grid, so the vertices
+        // are final as built
+        m_vertices.resize(m_width * m_depth);
+        InitHaloHeights();
+        InitVertices(m_vertices);
+        std::vector<float>().swap(m_haloHeights);
+        ComputeNormalsAndTangents(m_vertices, IndexBufferRegistry::GetTriangleList(m_width, m_depth));
+        m_gridHeights.resize(m_vertices.size());
+        for (std::size_t i = 0; i < m_gridHeights.size(); ++i) {
+            m_gridHeights[i] = m_vertices[i].Pos.y;
+        }
+        ComputeHeightRange(0.0f);
+        std::vector<float>().swap(m_gridHeights);
+        return;
+    }
+
+    InitNoiseSamples();
+    float skirtDepth = 0.0f;
+    if (m_topology == IndexTopology::Adaptive) {
+        BuildAdaptiveIndices(m_gridHeights.data(), m_width);
+    }
+    if (m_topology == IndexTopology::MipChain) {
+        ScreenSpaceError::ComputeLevelErrors(m_gridHeights.data(), m_width, m_depth,
+                                             IndexBufferRegistry::GetMipLevelCount(m_width, m_depth), m_levelErrors);
+        // Where neighbouring chunks are drawn at different levels, their shared edge differs by at
+        // most the coarser level's error, so skirts that deep close any crack. At least one grid
+        // spacing deep, to also hide the pinholes along the T-junctions.
+        skirtDepth = std::max(m_levelErrors.back(), 1.0f / m_terrainScale);
+    }
+    ComputeHeightRange(skirtDepth);
+
+    // The vertices are written once, from the noise samples straight into the mapped staging
+    // ring, so only the GPU-side copy is left for Upload(). A mesh kept for the cache gets its
+    // copy in the same pass, and the vectors are only the destination when the ring is full.
+    const std::size_t vertexCount = IndexBufferRegistry::GetVertexCount(m_width, m_depth, m_topology);
+    const std::size_t vertexSize = m_vertexFormat == VertexFormat::Compact ? sizeof(CompactVertex) : sizeof(Vertex);
+    const std::size_t stagedSize = vertexSize * vertexCount;
+    const bool staged = m_stagingRing && m_stagingRing->Reserve(stagedSize, m_stagingRegion);
+    const bool kept = !staged || m_retainMesh;
+    if (m_vertexFormat == VertexFormat::Compact) {
+        m_compactVertices.resize(kept ? vertexCount : 0);
+        CompactVertex* out = staged ? static_cast<CompactVertex*>(m_stagingRegion.Data) : m_compactVertices.data();
+        PackCompactVertices(out, staged && kept ? m_compactVertices.data() : nullptr, skirtDepth);
+    } else {
+        m_vertices.resize(kept ? vertexCount : 0);
+        Vertex* out = staged ? static_cast<Vertex*>(m_stagingRegion.Data) : m_vertices.data();
+        WriteNoiseVertices(out, staged && kept ? m_vertices.data() : nullptr, skirtDepth);
+    }
+    m_stagedSize = staged ? static_cast<GLsizeiptr>(stagedSize) : 0;
+    std::vector<float>().swap(m_gridHeights);
+    std::vector<glm::vec2>().swap(m_gridSlopes);
 }
 
-void Terrain::InitGLStates() {
-    glGenVertexArrays(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
-    glGenBuffers(1, &m_EBO);
+void Terrain::Upload() {
+    if (m_drawBatch) {
+        // Adaptive chunks draw their own indices, never a shared buffer
+        if (m_topology != IndexTopology::Adaptive) {
+            m_indexBuffer = &IndexBufferRegistry::GetBuffer(m_width, m_depth, m_topology);
+        }
+        m_batchSlot = m_drawBatch->Allocate();
+        if (m_stagedSize > 0) {
+            m_drawBatch->Copy(m_batchSlot, m_stagingRing->GetBuffer(), m_stagingRegion.Offset, m_stagedSize);
+        } else if (m_vertexFormat == VertexFormat::Compact) {
+            m_drawBatch->Upload(m_batchSlot, m_compactVertices.data(), sizeof(CompactVertex) * m_compactVertices.size());
+        } else {
+            m_drawBatch->Upload(m_batchSlot, m_vertices.data(), sizeof(Vertex) * m_vertices.size());
+        }
+    } else {
+        InitGLStates();
+        PopulateBuffer();
+        UnbindBuffers();
+    }
 
-    glBindVertexArray(m_VAO);
+    if (m_stagedSize > 0) {
+        m_stagingRing->Fence(m_stagingRegion);
+        m_stagedSize = 0;
+    }
+
+    // The GPU copy is all we need from here on
+    if (!m_retainMesh) {
+        std::vector<Vertex>().swap(m_vertices);
+        std::vector<CompactVertex>().swap(m_compactVertices);
+        std::vector<unsigned int>().swap(m_indices);
+        std::vector<std::uint16_t>().swap(m_heightTexels);
+    }
+    m_uploaded = true;
+}
+
+std::size_t Terrain::MeshData::GetSize() const {
+    return sizeof(Vertex) * Vertices.size() + sizeof(CompactVertex) * CompactVertices.size() +
+           sizeof(unsigned int) * Indices.size() + sizeof(std::uint16_t) * HeightTexels.size();
+}
+
+void Terrain::SetRetainMesh(bool retainMesh) {
+    m_retainMesh = retainMesh;
+}
+
+Terrain::MeshData Terrain::TakeMesh() {
+    MeshData mesh;
+    mesh.Format = m_vertexFormat;
+    mesh.Topology = m_topology;
+    mesh.Vertices = std::move(m_vertices);
+    mesh.CompactVertices = std::move(m_compactVertices);
+    mesh.MinHeight = m_minHeight;
+    mesh.MaxHeight = m_maxHeight;
+    mesh.LevelErrors = std::move(m_levelErrors);
+    mesh.Indices = std::move(m_indices);
+    mesh.HeightTexels = std::move(m_heightTexels);
+    m_vertices.clear();
+    m_compactVertices.clear();
+    m_indices.clear();
+    m_heightTexels.clear();
+    return mesh;
+}
 
-    SetupVertexAttribs(m_VBO, 0, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, Pos));
-    SetupVertexAttribs(m_VBO, 1, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-    SetupVertexAttribs(m_VBO, 2, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
-    SetupVertexAttribs(m_VBO, 3, 2, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+void Terrain::SetMesh(MeshData&& mesh) {
+    m_vertexFormat = mesh.Format;
+    m_vertices = std::move(mesh.Vertices);
+    m_compactVertices = std::move(mesh.CompactVertices);
+    m_minHeight = mesh.MinHeight;
+    m_maxHeight = mesh.MaxHeight;
+    m_levelErrors = std::move(mesh.LevelErrors);
+    m_indices = std::move(mesh.Indices);
+    m_heightTexels = std::move(mesh.HeightTexels);
+    m_indexCount = static_cast<GLsizei>(m_indices.size());
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+void Terrain::SetDrawBatch(ChunkDrawBatch* drawBatch) {
+    m_drawBatch = drawBatch;
+}
 
+ChunkDrawBatch* Terrain::GetDrawBatch() const {
+    return m_drawBatch;
+}
+
+ChunkDrawData Terrain::GetDrawData() const {
+    ChunkDrawData data{};
+    data.ChunkOrigin = glm::vec2(chunkX * (m_width - 1) / m_terrainScale, chunkZ * (m_depth - 1) / m_terrainScale);
+    data.HeightRange = glm::vec2(m_minHeight, m_maxHeight - m_minHeight);
+    return data;
+}
+
+void Terrain::AddToDrawBatch() const {
+    if (m_topology == IndexTopology::MipChain) {
+        AddToDrawBatch(0);
+        return;
+    }
+    m_drawBatch->Add(m_batchSlot, GetDrawData());
+}
+
+void Terrain::AddToDrawBatch(int level) const {
+    m_drawBatch->Add(m_batchSlot, GetDrawData(), m_indexBuffer->Levels[level], 0);
+}
+
+void Terrain::AddToDrawBatch(const std::vector<LodNode>& nodes, const ChunkLodQuadtree& lod) const {
+    ChunkDrawData data = GetDrawData();
+    for (const LodNode& node : nodes) {
+        bool morphs = node.Level < lod.GetLevelCount() - 1;
+        data.LodStep = morphs ? 1 << node.Level : 0;
+        data.MorphRange = morphs ? lod.GetMorphRange(node.Level) : glm::vec2(0.0f);
+
+        IndexRange range = m_indexBuffer->Levels[node.Level];
+        if (node.Quadrant >= 0) {
+            range.Count /= 4;
+            range.First += node.Quadrant * range.Count;
+        }
+        m_drawBatch->Add(m_batchSlot, data, range, node.Z * m_width + node.X);
+    }
+}
+
+bool Terrain::IsUploaded() const {
+    return m_uploaded;
+}
+
+std::size_t Terrain::GetUploadSize() const {
+    // A staged chunk's vectors only hold the copy kept for the cache, which is not uploaded
+    std::size_t vertexBytes = m_stagedSize > 0
+        ? static_cast<std::size_t>(m_stagedSize)
+        : sizeof(Vertex) * m_vertices.size() + sizeof(CompactVertex) * m_compactVertices.size();
+    return vertexBytes + sizeof(unsigned int) * m_indices.size() + sizeof(std::uint16_t) * m_heightTexels.size();
+}
+
+void Terrain::SetStagingRing(ChunkStagingRing* stagingRing) {
+    m_stagingRing = stagingRing;
+}
+
+void Terrain::SetHeightTextures(ChunkHeightTextures* heightTextures) {
+    m_heightTextures = heightTextures;
+}
+
+void Terrain::Cancel() {
+    m_cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool Terrain::IsCancelled() const {
+    return m_cancelled.load(std::memory_order_relaxed);
+}
+
+int Terrain::GetChunkX() const {
+    return chunkX;
+}
+
+int Terrain::GetChunkZ() const {
+    return chunkZ;
+}
+
+const std::vector<float>& Terrain::GetLevelErrors() const {
+    return m_levelErrors;
+}
+
+AABB Terrain::GetBounds() const {
+    // terrain.vs pushes vertices up to 0.04 along the normal, so pad by that much
+    const float displacement = 0.04f;
+    glm::vec3 origin(chunkX * (m_width - 1) / m_terrainScale, m_minHeight, chunkZ * (m_depth - 1) / m_terrainScale);
+    glm::vec3 extent((m_width - 1) / m_terrainScale, m_maxHeight - m_minHeight, (m_depth - 1) / m_terrainScale);
+    return AABB{ origin - displacement, origin + extent + displacement };
+}
+
+void Terrain::InitGLStates() {
+    ChunkBufferSlot slot = ChunkBufferPool::Acquire(m_vertexFormat, m_width, m_depth, m_topology);
+    m_VAO = slot.VAO;
+    m_VBO = slot.VBO;
+    m_VBOSize = slot.Size;
+    m_EBO = slot.EBO;
+    m_EBOSize = slot.EBOSize;
+    if (m_topology != IndexTopology::Adaptive) {
+        m_indexBuffer = &IndexBufferRegistry::GetBuffer(m_width, m_depth, m_topology);
+    }
+
+    // A recycled slot comes from a chunk with the same layout, so its VAO is already set up
+    if (m_VBOSize != 0) {
+        return;
+    }
+
+    glBindVertexArray(m_VAO);
+    SetupVertexFormat(m_vertexFormat, m_VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO != 0 ? m_EBO : m_indexBuffer->EBO);
     glBindVertexArray(0);
 }
 
-void Terrain::SetupVertexAttribs(GLuint buffer, GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) {
+void Terrain::SetupVertexFormat(VertexFormat vertexFormat, GLuint buffer) {
+    if (vertexFormat == VertexFormat::Compact) {
+        SetupVertexAttribs(buffer, 4, 1, GL_UNSIGNED_SHORT, sizeof(CompactVertex), (void*)offsetof(CompactVertex, Height), GL_TRUE);
+        SetupVertexAttribs(buffer, 5, 2, GL_SHORT, sizeof(CompactVertex), (void*)offsetof(CompactVertex, Normal), GL_TRUE);
+        SetupVertexAttribs(buffer, 6, 1, GL_UNSIGNED_SHORT, sizeof(CompactVertex), (void*)offsetof(CompactVertex, MorphHeight), GL_TRUE);
+    } else if (vertexFormat == VertexFormat::Standard) {
+        SetupVertexAttribs(buffer, 0, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, Pos));
+        SetupVertexAttribs(buffer, 1, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+        SetupVertexAttribs(buffer, 2, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
+        SetupVertexAttribs(buffer, 3, 2, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    }
+}
+
+void Terrain::SetupVertexAttribs(GLuint buffer, GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer,
+                                 GLboolean normalized) {
     glBindBuffer(GL_ARRAY_BUFFER, buffer);
     glEnableVertexAttribArray(index);
-    glVertexAttribPointer(index, size, type, GL_FALSE, stride, pointer);
+    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
 }
 
 void Terrain::PopulateBuffer() {
-    std::vector<Vertex> vertices(m_width * m_depth);
-    InitVertices(vertices);
-
-    std::vector<unsigned int> indices;
-    InitIndices(indices);
-    ComputeNormalsAndTangents(vertices, indices);
-
-    UploadBufferData(m_VBO, vertices.data(), sizeof(Vertex) * vertices.size());
-    UploadBufferData(m_EBO, indices.data(), sizeof(unsigned int) * indices.size());
+    if (m_topology == IndexTopology::Adaptive) {
+        // Binding to GL_ARRAY_BUFFER leaves the VAO's element buffer binding alone
+        glBindBuffer(GL_ARRAY_BUFFER, m_EBO);
+        GLsizeiptr size = sizeof(unsigned int) * m_indices.size();
+        if (size <= m_EBOSize) {
+            // Draws only read m_indexCount indices, so a larger buffer from a previous owner fits
+            glBufferSubData(GL_ARRAY_BUFFER, 0, size, m_indices.data());
+        } else {
+            glBufferData(GL_ARRAY_BUFFER, size, m_indices.data(), GL_STATIC_DRAW);
+            m_EBOSize = size;
+        }
+    }
+    if (m_vertexFormat == VertexFormat::HeightTexture) {
+        m_heightLayer = m_heightTextures->Allocate();
+        m_heightTextures->Upload(m_heightLayer, m_heightTexels.data());
+        return;
+    }
+    if (m_stagedSize > 0) {
+        CopyBufferData(m_VBO, m_stagingRing->GetBuffer(), m_stagingRegion.Offset, m_stagedSize);
+    } else if (m_vertexFormat == VertexFormat::Compact) {
+        UploadBufferData(m_VBO, m_compactVertices.data(), sizeof(CompactVertex) * m_compactVertices.size());
+    } else {
+        UploadBufferData(m_VBO, m_vertices.data(), sizeof(Vertex) * m_vertices.size());
+    }
 }
 
 template <typename T>
 void Terrain::UploadBufferData(GLuint buffer, const T* data, GLsizeiptr size) {
     glBindBuffer(GL_ARRAY_BUFFER, buffer);
-    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    if (size == m_VBOSize) {
+        // Overwrite the storage left by the previous owner of the slot instead of reallocating it
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+        m_VBOSize = size;
+    }
+}
+
+void Terrain::CopyBufferData(GLuint buffer, GLuint source, GLintptr sourceOffset, GLsizeiptr size) {
+    glBindBuffer(GL_COPY_READ_BUFFER, source);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    if (size != m_VBOSize) {
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+        m_VBOSize = size;
+    }
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, 0, size);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+float Terrain::SampleNoiseHeight(const siv::PerlinNoise& perlin, float worldX, float worldZ) {
+    float y = perlin.octave2D_01<kNoiseOctaves>(worldX * 0.1, worldZ * 0.1);
+    return y * 20 - 20;
+}
+
+float Terrain::SampleNoiseHeight(const siv::PerlinNoise& perlin, float worldX, float worldZ, float sampleSpacing) {
+    float y = perlin.filteredOctave2D_01(worldX * 0.1, worldZ * 0.1, kNoiseOctaves, sampleSpacing * 0.1);
+    return y * 20 - 20;
+}
+
+void Terrain::SampleHeightRow(int gridX, int gridZ, int count, float* out, std::vector<double>& scratch) const {
+    // Same positions and arithmetic as SampleNoiseHeight() at (grid / m_terrainScale), so the row
+    // call returns the same heights, only several at a time
+    scratch.resize(static_cast<size_t>(count) * 2);
+    double* xs = scratch.data();
+    double* noise = xs + count;
+    for (int x = 0; x < count; ++x) {
+        xs[x] = static_cast<float>((gridX + x) / m_terrainScale) * 0.1;
+    }
+    const float worldZ = gridZ / m_terrainScale;
+    m_perlin.octave2D_01Row<kNoiseOctaves>(xs, worldZ * 0.1, count, noise);
+    for (int x = 0; x < count; ++x) {
+        float y = noise[x];
+        out[x] = y * 20 - 20;
+    }
+}
+
+void Terrain::InitHaloHeights() {
+    const int haloWidth = m_width + 2;
+    const int haloDepth = m_depth + 2;
+    const int originX = chunkX * (m_width - 1) - 1;
+    const int originZ = chunkZ * (m_depth - 1) - 1;
+    m_haloHeights.resize(static_cast<size_t>(haloWidth) * haloDepth);
+
+    TaskScheduler::Instance().ParallelFor(0, haloDepth, 8, [&](int start, int end) {
+        std::vector<double> scratch;
+        for (int z = start; z < end; ++z) {
+            SampleHeightRow(originX, originZ + z, haloWidth, &m_haloHeights[z * haloWidth], scratch);
+        }
+    });
 }
 
 void Terrain::InitVertices(std::vector<Vertex>& vertices) {
-    float texScale = 100.0f;
+    float texScale = kTexScale;
+    const int haloWidth = m_width + 2;
     auto initVertexRange = [&](int start, int end) {
         for (int z = start; z < end; ++z) {
             for (int x = 0; x < m_width; ++x) {
@@ -78,24 +441,89 @@ void Terrain::InitVertices(std::vector<Vertex>& vertices) {
                 float v = static_cast<float>(z) / m_depth * texScale;
                 float worldX = (chunkX * (m_width - 1) + x) / m_terrainScale;
                 float worldZ = (chunkZ * (m_depth - 1) + z) / m_terrainScale;
-                float y = m_perlin.octave2D_01(worldX * 0.1, worldZ * 0.1, 10);
-                vertices[index].InitVertex(worldX, y * 20 - 20, worldZ, u, v);
+                float y = m_haloHeights[(z + 1) * haloWidth + x + 1];
+                vertices[index].InitVertex(worldX, y, worldZ, u, v);
             }
         }
     };
 
-    std::vector<std::thread> threads;
-    unsigned int numThreads = std::thread::hardware_concurrency();
-    int chunkSize = m_depth / numThreads;
-    for (int i = 0; i < numThreads; ++i) {
-        int start = i * chunkSize;
-        int end = (i == numThreads - 1) ? m_depth : start + chunkSize;
-        threads.emplace_back(initVertexRange, start, end);
-    }
+    TaskScheduler::Instance().ParallelFor(0, m_depth, 8, initVertexRange);
+}
 
-    for (auto& thread : threads) {
-        thread.join();
+void Terrain::InitNoiseSamples() {
+    // Heights as in SampleHeightRow(), with the noise derivatives taken through the same chain:
+    // dH/dx = 20 * 0.1 * dNoise/dx. Being exact rather than differenced, the slopes agree with
+    // the neighbouring chunk along shared edges without sampling past the border. The slopes
+    // only carry the octaves the vertex spacing can represent; finer ones would light detail the
+    // mesh does not have and alias between vertices.
+    const double vertexSpacing = 0.1 / m_terrainScale; // in noise units
+    const int originX = chunkX * (m_width - 1);
+    const int originZ = chunkZ * (m_depth - 1);
+    m_gridHeights.resize(static_cast<size_t>(m_width) * m_depth);
+    m_gridSlopes.resize(m_gridHeights.size());
+
+    TaskScheduler::Instance().ParallelFor(0, m_depth, 8, [&](int start, int end) {
+        std::vector<double> scratch(static_cast<size_t>(m_width) * 4);
+        double* xs = scratch.data();
+        double* noise = xs + m_width;
+        double* noiseDx = noise + m_width;
+        double* noiseDz = noiseDx + m_width;
+        for (int x = 0; x < m_width; ++x) {
+            xs[x] = static_cast<float>((originX + x) / m_terrainScale) * 0.1;
+        }
+        for (int z = start; z < end; ++z) {
+            const float worldZ = (originZ + z) / m_terrainScale;
+            m_perlin.octave2D_01RowDerivatives(xs, worldZ * 0.1, m_width, noise, noiseDx, noiseDz, kNoiseOctaves, 0.5, vertexSpacing);
+            for (int x = 0; x < m_width; ++x) {
+                float y = noise[x];
+                m_gridHeights[z * m_width + x] = y * 20 - 20;
+                m_gridSlopes[z * m_width + x] = glm::vec2(noiseDx[x] * 2.0, noiseDz[x] * 2.0);
+            }
+        }
+    });
+}
+
+int Terrain::GetSourceIndex(int index) const {
+    // Skirt vertices follow the grid, one row of m_width per edge, each below a grid edge vertex
+    const int gridVertices = m_width * m_depth;
+    if (index < gridVertices) {
+        return index;
     }
+    int edge = (index - gridVertices) / m_width;
+    int t = (index - gridVertices) % m_width;
+    return edge == 0 ? t
+         : edge == 1 ? (m_depth - 1) * m_width + t
+         : edge == 2 ? t * m_width
+         : t * m_width + m_width - 1;
+}
+
+void Terrain::WriteNoiseVertices(Vertex* out, Vertex* copy, float skirtDepth) const {
+    // With slopes sx and sz the normal is proportional to (-sx, 1, -sz) and the tangent, which
+    // follows u along +X, to (1, sx, 0)
+    const float texScale = kTexScale;
+    const int gridVertices = m_width * m_depth;
+    const int vertexCount = IndexBufferRegistry::GetVertexCount(m_width, m_depth, m_topology);
+    TaskScheduler::Instance().ParallelFor(0, vertexCount, 4096, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            int source = GetSourceIndex(i);
+            int x = source % m_width;
+            int z = source / m_width;
+            float u = static_cast<float>(x) / m_width * texScale;
+            float v = static_cast<float>(z) / m_depth * texScale;
+            float worldX = (chunkX * (m_width - 1) + x) / m_terrainScale;
+            float worldZ = (chunkZ * (m_depth - 1) + z) / m_terrainScale;
+            float y = m_gridHeights[source] - (i >= gridVertices ? skirtDepth : 0.0f);
+            glm::vec2 slope = m_gridSlopes[source];
+            Vertex vertex;
+            vertex.InitVertex(worldX, y, worldZ, u, v);
+            vertex.Normal = glm::normalize(glm::vec3(-slope.x, 1.0f, -slope.y));
+            vertex.Tangent = glm::normalize(glm::vec3(1.0f, slope.x, 0.0f));
+            out[i] = vertex;
+            if (copy) {
+                copy[i] = vertex;
+            }
+        }
+    });
 }
 
 void Terrain::Vertex::InitVertex(double x, double y, double z, double u, double v) {
@@ -105,12 +533,114 @@ void Terrain::Vertex::InitVertex(double x, double y, double z, double u, double
     TexCoords = glm::vec2(u, v);
 }
 
-void Terrain::Render() {
+void Terrain::Render(Shader& shader) {
+    SetChunkUniforms(shader);
+    shader.setInt("lodStep", 0);
+
+    glBindVertexArray(m_VAO);
+    if (m_topology == IndexTopology::Adaptive) {
+        glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+        return;
+    }
+    if (m_topology == IndexTopology::LodNodes) {
+        // Without a node selection the whole chunk is drawn as its own node
+        DrawNode(LodNode{ 0, 0, static_cast<int>(m_indexBuffer->Levels.size()) - 1 - kLodBlockLevels, -1 });
+        glBindVertexArray(0);
+        return;
+    }
+    if (m_topology == IndexTopology::MipChain) {
+        glBindVertexArray(0);
+        RenderLevel(shader, 0);
+        return;
+    }
+    if (m_indexBuffer->PrimitiveRestart) {
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(m_indexBuffer->RestartIndex);
+    }
+    glDrawElements(m_indexBuffer->Mode, m_indexBuffer->Count, m_indexBuffer->Type, 0);
+    if (m_indexBuffer->PrimitiveRestart) {
+        glDisable(GL_PRIMITIVE_RESTART);
+    }
+    glBindVertexArray(0);
+}
+
+void Terrain::RenderNodes(Shader& shader, const std::vector<LodNode>& nodes, const ChunkLodQuadtree& lod) {
+    SetChunkUniforms(shader);
+
+    glBindVertexArray(m_VAO);
+    for (const LodNode& node : nodes) {
+        // The top level has no coarser grid to morph into
+        bool morphs = node.Level < lod.GetLevelCount() - 1;
+        GLint lodStep = morphs ? 1 << node.Level : 0;
+        shader.setInt("lodStep", lodStep);
+        if (morphs) {
+            shader.setVec2("morphRange", lod.GetMorphRange(node.Level));
+        }
+        DrawNode(node);
+    }
+    glBindVertexArray(0);
+}
+
+void Terrain::RenderLevel(Shader& shader, int level) {
+    SetChunkUniforms(shader);
+    shader.setInt("lodStep", 0);
+
+    const IndexRange& range = m_indexBuffer->Levels[level];
+    std::size_t indexSize = m_indexBuffer->Type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
     glBindVertexArray(m_VAO);
-    glDrawElements(GL_TRIANGLES, (m_width - 1) * (m_depth - 1) * 6, GL_UNSIGNED_INT, 0);
+    glDrawElements(m_indexBuffer->Mode, range.Count, m_indexBuffer->Type, (void*)(range.First * indexSize));
     glBindVertexArray(0);
 }
 
+void Terrain::DrawNode(const LodNode& node) const {
+    const IndexRange& range = m_indexBuffer->Levels[node.Level];
+    GLuint first = range.First;
+    GLsizei count = range.Count;
+    if (node.Quadrant >= 0) {
+        count /= 4;
+        first += node.Quadrant * count;
+    }
+    std::size_t indexSize = m_indexBuffer->Type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    glDrawElementsBaseVertex(m_indexBuffer->Mode, count, m_indexBuffer->Type, (void*)(first * indexSize),
+                             node.Z * m_width + node.X);
+}
+
+void Terrain::SetChunkUniforms(Shader& shader) const {
+    shader.setBool("compactVertices", m_vertexFormat == VertexFormat::Compact);
+    shader.setBool("heightTexture", m_vertexFormat == VertexFormat::HeightTexture);
+    if (m_vertexFormat == VertexFormat::HeightTexture) {
+        shader.setInt("heightTextures", kHeightTextureUnit);
+        shader.setInt("heightLayer", m_heightLayer.Index);
+        glActiveTexture(GL_TEXTURE0 + kHeightTextureUnit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_heightTextures->GetTexture(m_heightLayer));
+        glActiveTexture(GL_TEXTURE0);
+    }
+    if (m_vertexFormat != VertexFormat::Standard) {
+        shader.setVec2("chunkOrigin", chunkX * (m_width - 1) / m_terrainScale, chunkZ * (m_depth - 1) / m_terrainScale);
+        shader.setFloat("gridSpacing", 1.0f / m_terrainScale);
+        shader.setInt("gridWidth", m_width);
+        shader.setInt("gridDepth", m_depth);
+        shader.setFloat("texScale", kTexScale);
+        shader.setVec2("heightRange", m_minHeight, m_maxHeight - m_minHeight);
+    }
+}
+
+IndexTopology Terrain::GetIndexTopology() const {
+    return m_topology;
+}
+
+std::size_t Terrain::GetTriangleCount() const {
+    if (m_topology == IndexTopology::Adaptive) {
+        return static_cast<std::size_t>(m_indexCount) / 3;
+    }
+    return static_cast<std::size_t>(m_width - 1) * (m_depth - 1) * 2;
+}
+
+void Terrain::SetAdaptiveMaxError(float maxError) {
+    m_adaptiveMaxError = maxError;
+}
+
 void Terrain::InitHeightMap() {
     if (!m_perlinNoise) {
         HeightMap heightMap;
@@ -121,68 +651,156 @@ void Terrain::InitHeightMap() {
     }
 }
 
-void Terrain::InitIndices(std::vector<unsigned int>& indices) {
-    for (int z = 0; z < m_depth - 1; ++z) {
-        for (int x = 0; x < m_width - 1; ++x) {
-            int topLeft = (z * m_width) + x;
-            int topRight = topLeft + 1;
-            int bottomLeft = ((z + 1) * m_width) + x;
-            int bottomRight = bottomLeft + 1;
-
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
-        }
-    }
-}
-
 void Terrain::ComputeNormalsAndTangents(std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
     std::vector<glm::vec3> vertexNormals(vertices.size(), glm::vec3(0.0f));
     std::vector<glm::vec3> vertexTangents(vertices.size(), glm::vec3(0.0f));
 
-    // Iterate over each triangle
-    for (size_t i = 0; i < indices.size(); i += 3) {
-        unsigned int i0 = indices[i];
-        unsigned int i1 = indices[i + 1];
-        unsigned int i2 = indices[i + 2];
+    auto accumulateTriangles = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i += 3) {
+            unsigned int i0 = indices[i];
+            unsigned int i1 = indices[i + 1];
+            unsigned int i2 = indices[i + 2];
+
+            Vertex& v0 = vertices[i0];
+            Vertex& v1 = vertices[i1];
+            Vertex& v2 = vertices[i2];
 
-        Vertex& v0 = vertices[i0];
-        Vertex& v1 = vertices[i1];
-        Vertex& v2 = vertices[i2];
+            glm::vec3 edge1 = v1.Pos - v0.Pos;
+            glm::vec3 edge2 = v2.Pos - v0.Pos;
 
-        glm::vec3 edge1 = v1.Pos - v0.Pos;
-        glm::vec3 edge2 = v2.Pos - v0.Pos;
+            glm::vec3 faceNormal = glm::normalize(glm::cross(edge1, edge2));
 
-        glm::vec3 faceNormal = glm::normalize(glm::cross(edge1, edge2));
+            vertexNormals[i0] += faceNormal;
+            vertexNormals[i1] += faceNormal;
+            vertexNormals[i2] += faceNormal;
 
-        vertexNormals[i0] += faceNormal;
-        vertexNormals[i1] += faceNormal;
-        vertexNormals[i2] += faceNormal;
+            glm::vec2 deltaUV1 = v1.TexCoords - v0.TexCoords;
+            glm::vec2 deltaUV2 = v2.TexCoords - v0.TexCoords;
 
-        glm::vec2 deltaUV1 = v1.TexCoords - v0.TexCoords;
-        glm::vec2 deltaUV2 = v2.TexCoords - v0.TexCoords;
+            float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
 
-        float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
+            glm::vec3 tangent;
+            tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
+            tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
+            tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
 
-        glm::vec3 tangent;
-        tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
-        tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
-        tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
+            vertexTangents[i0] += tangent;
+            vertexTangents[i1] += tangent;
+            vertexTangents[i2] += tangent;
+        }
+    };
 
-        vertexTangents[i0] += tangent;
-        vertexTangents[i1] += tangent;
-        vertexTangents[i2] += tangent;
+    // Indices come from IndexBufferRegistry, one row of quads after another, and a quad row only touches
+    // its two vertex rows. Bands of quad rows are therefore accumulated in two phases, even bands
+    // then odd bands, so no two bands running at the same time write the same vertex.
+    const int bandRows = 8;
+    const size_t indicesPerRow = static_cast<size_t>(m_width - 1) * 6;
+    const int numBands = (m_depth - 1 + bandRows - 1) / bandRows;
+    for (int phase = 0; phase < 2; ++phase) {
+        TaskScheduler::Instance().ParallelFor(0, (numBands - phase + 1) / 2, 1, [&](int begin, int end) {
+            for (int pair = begin; pair < end; ++pair) {
+                size_t band = static_cast<size_t>(pair) * 2 + phase;
+                size_t first = band * bandRows * indicesPerRow;
+                size_t last = std::min(indices.size(), first + bandRows * indicesPerRow);
+                accumulateTriangles(first, last);
+            }
+        });
     }
 
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        vertices[i].Normal = glm::normalize(vertexNormals[i]);
-        vertices[i].Tangent = glm::normalize(vertexTangents[i]);
+    TaskScheduler::Instance().ParallelFor(0, static_cast<int>(vertices.size()), 4096, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            vertices[i].Normal = glm::normalize(vertexNormals[i]);
+            vertices[i].Tangent = glm::normalize(vertexTangents[i]);
+        }
+    });
+}
+
+void Terrain::BuildAdaptiveIndices(const float* heights, int rowStride) {
+    const RtinMesher& mesher = RtinMesher::Get(m_width);
+    const std::size_t vertexCount = static_cast<std::size_t>(m_width) * m_depth;
+    std::vector<float> errors;
+    mesher.ComputeErrors(heights, rowStride, errors);
+    m_indices.clear();
+    mesher.Extract(errors, m_adaptiveMaxError, m_indices);
+    VertexCacheOptimizer::Optimize(m_indices.data(), m_indices.size(), vertexCount);
+    m_indexCount = static_cast<GLsizei>(m_indices.size());
+}
+
+void Terrain::PackHeightTexels() {
+    // The border texels are quantized too, so the range covers the whole halo
+    auto [lowest, highest] = std::minmax_element(m_haloHeights.begin(), m_haloHeights.end());
+    m_minHeight = *lowest;
+    m_maxHeight = *highest;
+    float range = m_maxHeight - m_minHeight;
+    float heightScale = range > 0.0f ? 65535.0f / range : 0.0f;
+
+    m_heightTexels.resize(m_haloHeights.size());
+    TaskScheduler::Instance().ParallelFor(0, static_cast<int>(m_haloHeights.size()), 4096, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            m_heightTexels[i] = static_cast<std::uint16_t>(std::lround((m_haloHeights[i] - m_minHeight) * heightScale));
+        }
+    });
+}
+
+void Terrain::ComputeHeightRange(float skirtDepth) {
+    auto [lowest, highest] = std::minmax_element(m_gridHeights.begin(), m_gridHeights.end());
+    m_minHeight = *lowest;
+    m_maxHeight = *highest;
+    if (m_topology == IndexTopology::MipChain) {
+        const int gridVertices = m_width * m_depth;
+        for (int i = gridVertices; i < gridVertices + 4 * m_width; ++i) {
+            m_minHeight = std::min(m_minHeight, m_gridHeights[GetSourceIndex(i)] - skirtDepth);
+        }
     }
 }
 
+void Terrain::PackCompactVertices(CompactVertex* out, CompactVertex* copy, float skirtDepth) const {
+    float range = m_maxHeight - m_minHeight;
+    float heightScale = range > 0.0f ? 65535.0f / range : 0.0f;
+    auto quantize = [&](float height) {
+        return static_cast<std::uint16_t>(std::lround((height - m_minHeight) * heightScale));
+    };
+
+    const int gridVertices = m_width * m_depth;
+    const int vertexCount = IndexBufferRegistry::GetVertexCount(m_width, m_depth, m_topology);
+    TaskScheduler::Instance().ParallelFor(0, vertexCount, 4096, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            int source = GetSourceIndex(i);
+            glm::vec2 slope = m_gridSlopes[source];
+            glm::vec3 normal = glm::normalize(glm::vec3(-slope.x, 1.0f, -slope.y));
+            glm::vec2 octNormal = glm::clamp(OctEncode(normal), -1.0f, 1.0f);
+            CompactVertex packed;
+            packed.Normal[0] = static_cast<std::int16_t>(std::lround(octNormal.x * 32767.0f));
+            packed.Normal[1] = static_cast<std::int16_t>(std::lround(octNormal.y * 32767.0f));
+
+            // Skirt vertices after the grid never morph
+            if (i >= gridVertices) {
+                packed.Height = quantize(m_gridHeights[source] - skirtDepth);
+                packed.MorphHeight = packed.Height;
+            } else {
+                packed.Height = quantize(m_gridHeights[i]);
+                packed.MorphHeight = packed.Height;
+                // A vertex is odd in exactly one LOD grid, the one whose step is its largest
+                // power-of-two divisor, and there it morphs onto its even neighbour towards the
+                // chunk corner
+                unsigned x = static_cast<unsigned>(i % m_width);
+                unsigned z = static_cast<unsigned>(i / m_width);
+                int shift = std::min(x ? std::countr_zero(x) : 31, z ? std::countr_zero(z) : 31);
+                if (shift < 31) {
+                    unsigned step = 1u << shift;
+                    unsigned targetX = (x >> shift) & 1u ? x - step : x;
+                    unsigned targetZ = (z >> shift) & 1u ? z - step : z;
+                    packed.MorphHeight = quantize(m_gridHeights[targetZ * m_width + targetX]);
+                }
+            }
+            out[i] = packed;
+            if (copy) {
+                copy[i] = packed;
+            }
+        }
+    });
+}
+
 void Terrain::UnbindBuffers() {
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -14,17 +14,45 @@
 //#include "PerlinNoise.h"
 #include <unordered_map>
 #include <utility>
+#include <atomic>
 #include "PerlinNoise.hpp"
+#include "IndexBufferRegistry.h"
+#include "shader.h"
+#include "Frustum.h"
+#include <cstdint>
+#include "ChunkStagingRing.h"
+#include "ChunkLodQuadtree.h"
+#include "ChunkHeightTextures.h"
+
+class ChunkDrawBatch;
+struct ChunkDrawData;
+
+enum class VertexFormat {
+    // 44 bytes: position, normal, tangent and texture coordinates
+    Standard,
+    // 8 bytes: quantized height and octahedral normal; terrain.vs rebuilds the rest from
+    // gl_VertexID and the per-chunk uniforms set in Terrain::Render
+    Compact,
+    // No vertex buffer at all: the chunk's heights go into a ChunkHeightTextures layer, and
+    // terrain.vs places the grid vertex from gl_VertexID and takes height and normal from the
+    // texture. Not usable with IndexTopology::MipChain, whose skirts need vertices.
+    HeightTexture
+};
 
 
 class Terrain {
 public:
-    Terrain(int width, int depth, bool perlinNoise = false);
-    Terrain(int x, int z, int chunkSize, float terrainScale);
+    static constexpr float kTexScale = 100.0f;
+    static constexpr siv::PerlinNoise::seed_type kNoiseSeed = 123456u;
+    // Fixed so the noise calls take the unrolled octave2D<N> specializations
+    static constexpr std::int32_t kNoiseOctaves = 10;
+
+    // The procedural heightfield every Perlin chunk samples, shared with other terrain modes
+    static float SampleNoiseHeight(const siv::PerlinNoise& perlin, float worldX, float worldZ);
+    // The same heightfield band-limited for samples sampleSpacing world units apart, leaving out
+    // the octaves that would alias at that spacing and fading in the last one kept
+    static float SampleNoiseHeight(const siv::PerlinNoise& perlin, float worldX, float worldZ, float sampleSpacing);
 
-    void Render();
-    void Generate();
-private:
     struct Vertex {
         glm::vec3 Pos;
         glm::vec3 Normal;
@@ -33,11 +61,97 @@ private:
         void InitVertex(double x, double y, double z, double u, double v);
     };
 
+    struct CompactVertex {
+        std::uint16_t Height;
+        std::int16_t Normal[2];
+        // Height of the vertex this one collapses onto when its CDLOD node morphs into the next
+        // coarser level, quantized like Height
+        std::uint16_t MorphHeight;
+    };
+
+    // CPU side of a built chunk, enough to upload it again without regenerating it
+    struct MeshData {
+        VertexFormat Format = VertexFormat::Standard;
+        // Only MipChain meshes carry skirts and level errors
+        IndexTopology Topology = IndexTopology::TriangleStrip;
+        std::vector<Vertex> Vertices;
+        std::vector<CompactVertex> CompactVertices;
+        float MinHeight = 0.0f;
+        float MaxHeight = 0.0f;
+        std::vector<float> LevelErrors;
+        // Adaptive only
+        std::vector<unsigned int> Indices;
+        // HeightTexture only
+        std::vector<std::uint16_t> HeightTexels;
+
+        std::size_t GetSize() const;
+    };
+
+    Terrain(int width, int depth, bool perlinNoise = false);
+    Terrain(int x, int z, int chunkSize, float terrainScale,
+            IndexTopology topology = IndexTopology::TriangleStrip,
+            VertexFormat vertexFormat = VertexFormat::Standard);
+    // Hands the VAO/VBO back to ChunkBufferPool, so it must run on the GL thread once uploaded
+    ~Terrain();
+
+    void Render(Shader& shader);
+    // For chunks created with IndexTopology::LodNodes, draws the nodes picked by the quadtree
+    void RenderNodes(Shader& shader, const std::vector<LodNode>& nodes, const ChunkLodQuadtree& lod);
+    // For chunks created with IndexTopology::MipChain, draws one mip level with its skirts
+    void RenderLevel(Shader& shader, int level);
+    IndexTopology GetIndexTopology() const;
+    // Triangles drawn by Render()
+    std::size_t GetTriangleCount() const;
+    // For IndexTopology::Adaptive chunks, the largest height error in world units the RTIN mesh
+    // may leave; set before BuildMesh()
+    void SetAdaptiveMaxError(float maxError);
+    void Generate();
+
+    // Generate() is split into a CPU stage that may run on a worker thread and a GL stage
+    // that must run on the thread owning the context.
+    void BuildMesh();
+    void Upload();
+
+    bool IsUploaded() const;
+    std::size_t GetUploadSize() const;
+    void Cancel();
+    bool IsCancelled() const;
+    int GetChunkX() const;
+    int GetChunkZ() const;
+    // World-space bounds, valid once BuildMesh() has run
+    AABB GetBounds() const;
+    // MipChain only: largest height difference between the full grid and each mip level,
+    // finest first, valid once BuildMesh() has run
+    const std::vector<float>& GetLevelErrors() const;
+
+    // By default the CPU mesh is dropped once uploaded; a retained one can be taken back out
+    // when the chunk is evicted and handed to a new chunk in place of BuildMesh()
+    void SetRetainMesh(bool retainMesh);
+    MeshData TakeMesh();
+    void SetMesh(MeshData&& mesh);
+
+    // Set before Upload() to place the vertices in a slot of the batch's shared buffer instead of
+    // a VBO of their own; such chunks are drawn through AddToDrawBatch() rather than Render()
+    void SetDrawBatch(ChunkDrawBatch* drawBatch);
+    ChunkDrawBatch* GetDrawBatch() const;
+    void AddToDrawBatch() const;
+    void AddToDrawBatch(const std::vector<LodNode>& nodes, const ChunkLodQuadtree& lod) const;
+    void AddToDrawBatch(int level) const;
+
+    // Set before BuildMesh() to have the worker write the finished vertices into the ring
+    // instead of a vector; falls back to the vector when the ring is full. A retained mesh is
+    // written to both.
+    void SetStagingRing(ChunkStagingRing* stagingRing);
+    // Required before Upload() for VertexFormat::HeightTexture chunks
+    void SetHeightTextures(ChunkHeightTextures* heightTextures);
+
+    // Attribute layout of the vertex format, recorded into the currently bound VAO
+    static void SetupVertexFormat(VertexFormat vertexFormat, GLuint buffer);
+private:
     int chunkX;
     int chunkZ;
 
-    const siv::PerlinNoise::seed_type seed = 123456u;
-    const siv::PerlinNoise m_perlin{ seed };
+    const siv::PerlinNoise m_perlin{ kNoiseSeed };
 
     bool m_perlinNoise = false;
     int m_width;
@@ -45,18 +159,73 @@ private:
     float m_terrainScale;
     std::vector<double> m_heightmap;
     std::vector<glm::vec3> m_normals;
+    std::vector<Vertex> m_vertices;
+    // Heights of the chunk plus a one-sample border taken from the noise, so that central
+    // differences at the chunk edges see the same neighbours as the adjacent chunk
+    std::vector<float> m_haloHeights;
+    // Perlin chunks: height and slope of every grid vertex, from which the vertices of either
+    // format are written; dropped at the end of BuildMesh()
+    std::vector<float> m_gridHeights;
+    std::vector<glm::vec2> m_gridSlopes;
+    std::vector<CompactVertex> m_compactVertices;
+    float m_minHeight = 0.0f;
+    float m_maxHeight = 0.0f;
+    std::vector<float> m_levelErrors;
+    // Adaptive only: the chunk's RTIN triangles until uploaded, then just their count
+    std::vector<unsigned int> m_indices;
+    GLsizei m_indexCount = 0;
+    float m_adaptiveMaxError = 0.0f;
+    // HeightTexture only: the chunk's texels until uploaded, then the layer holding them
+    std::vector<std::uint16_t> m_heightTexels;
+    ChunkHeightTextures* m_heightTextures = nullptr;
+    ChunkHeightTextures::Layer m_heightLayer;
+    bool m_uploaded = false;
+    bool m_retainMesh = false;
+    std::atomic<bool> m_cancelled{ false };
     unsigned int m_VAO = 0;
     unsigned int m_VBO = 0;
     unsigned int m_EBO = 0;
+    // Bytes allocated in m_VBO, 0 until the first upload into it
+    GLsizeiptr m_VBOSize = 0;
+    // Bytes allocated in m_EBO, which may exceed what this chunk's indices take
+    GLsizeiptr m_EBOSize = 0;
+    IndexTopology m_topology = IndexTopology::TriangleStrip;
+    VertexFormat m_vertexFormat = VertexFormat::Standard;
+    const SharedIndexBuffer* m_indexBuffer = nullptr;
+    ChunkDrawBatch* m_drawBatch = nullptr;
+    int m_batchSlot = -1;
+    ChunkStagingRing* m_stagingRing = nullptr;
+    ChunkStagingRing::Region m_stagingRegion;
+    // Bytes waiting in m_stagingRegion, 0 when the vertices are in the vectors instead
+    GLsizeiptr m_stagedSize = 0;
 
     void PopulateBuffer();
+    void SetChunkUniforms(Shader& shader) const;
+    ChunkDrawData GetDrawData() const;
+    void DrawNode(const LodNode& node) const;
+    // count heights along +x from (gridX, gridZ) through the SIMD row noise; scratch is reused
+    // across calls
+    void SampleHeightRow(int gridX, int gridZ, int count, float* out, std::vector<double>& scratch) const;
+    void InitHaloHeights();
     void InitVertices(std::vector<Vertex>& Vertices);
+    // Perlin chunks: m_gridHeights and m_gridSlopes from one pass of derivative noise
+    void InitNoiseSamples();
+    // Grid vertex a vertex takes its sample from, itself unless it is a skirt vertex
+    int GetSourceIndex(int index) const;
+    // Both write every vertex of the topology to out and, when given, to copy as well
+    void WriteNoiseVertices(Vertex* out, Vertex* copy, float skirtDepth) const;
+    void PackCompactVertices(CompactVertex* out, CompactVertex* copy, float skirtDepth) const;
     void InitGLStates();
     void InitHeightMap();
-    void InitIndices(std::vector<unsigned int>& Indices);
+    // Triangle accumulation, only needed for meshes that are not a regular height grid
     void ComputeNormalsAndTangents(std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+    void BuildAdaptiveIndices(const float* heights, int rowStride);
+    void PackHeightTexels();
+    void ComputeHeightRange(float skirtDepth);
     void UnbindBuffers();
-    void SetupVertexAttribs(GLuint buffer, GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer);
+    static void SetupVertexAttribs(GLuint buffer, GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer,
+                            GLboolean normalized = GL_FALSE);
+    void CopyBufferData(GLuint buffer, GLuint source, GLintptr sourceOffset, GLsizeiptr size);
     template <typename T>
     void UploadBufferData(GLuint buffer, const T* data, GLsizeiptr size);
 };
@@ -0,0 +1,163 @@
+//
+// Created by Lucas Wang on 2024-09-02.
+//
+
+#include "ChunkLodQuadtree.h"
+#include "TestCheck.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <utility>
+
+static const int kChunkSize = 257;
+static const float kTerrainScale = 20.0f;
+static const float kLeafRange = 3.0f * kLodNodeQuads / kTerrainScale;
+
+static AABB ChunkBounds(int chunkX, int chunkZ) {
+    const float extent = (kChunkSize - 1) / kTerrainScale;
+    return AABB{ glm::vec3(chunkX * extent, -20.0f, chunkZ * extent), glm::vec3((chunkX + 1) * extent, 0.0f, (chunkZ + 1) * extent) };
+}
+
+// Sees everything, so selection only depends on distance
+static Frustum EverythingFrustum() {
+    return Frustum(glm::ortho(-1e5f, 1e5f, -1e5f, 1e5f, -1e5f, 1e5f));
+}
+
+static void TestLevels() {
+    ChunkLodQuadtree lod(kChunkSize, kTerrainScale, kLeafRange);
+    // 32, 64, 128 and 256 quads inside a chunk, then the block levels
+    Check(lod.GetChunkLevel() == 3, "a 257-sample chunk is the node of level 3");
+    Check(lod.GetLevelCount() == 4 + kLodBlockLevels, "block levels follow the chunk level");
+    Check(ChunkLodQuadtree(100, kTerrainScale, kLeafRange).GetLevelCount() == 0, "unsupported chunk sizes have no levels");
+    for (int level = 1; level < lod.GetLevelCount(); ++level) {
+        Check(lod.GetRange(level) == 2.0f * lod.GetRange(level - 1), "ranges double per level");
+    }
+}
+
+static void TestMorphRanges() {
+    ChunkLodQuadtree lod(kChunkSize, kTerrainScale, kLeafRange);
+    for (int level = 0; level < lod.GetLevelCount(); ++level) {
+        glm::vec2 morph = lod.GetMorphRange(level);
+        float previous = level > 0 ? lod.GetRange(level - 1) : 0.0f;
+        Check(morph.y == lod.GetRange(level), "morphing ends at the level's range");
+        Check(morph.x > previous && morph.x < morph.y, "morphing starts between the previous range and the level's own");
+    }
+}
+
+// Marks the quads each piece of a chunk covers and checks every quad is drawn exactly once
+static void TestChunkCoverage(const glm::vec3& camera) {
+    ChunkLodQuadtree lod(kChunkSize, kTerrainScale, kLeafRange);
+    const int quads = kChunkSize - 1;
+    Frustum frustum = EverythingFrustum();
+    for (int chunkZ = -3; chunkZ <= 3; ++chunkZ) {
+        for (int chunkX = -3; chunkX <= 3; ++chunkX) {
+            std::vector<LodNode> nodes;
+            lod.Select(chunkX, chunkZ, ChunkBounds(chunkX, chunkZ), camera, frustum, nodes);
+            Check(!nodes.empty(), "every visible chunk draws something");
+            std::vector<int> covered(static_cast<size_t>(quads) * quads, 0);
+            for (const LodNode& node : nodes) {
+                int size = node.Level > lod.GetChunkLevel() ? quads : kLodNodeQuads << node.Level;
+                int x0 = node.X;
+                int z0 = node.Z;
+                if (node.Quadrant >= 0) {
+                    size /= 2;
+                    x0 += (node.Quadrant % 2) * size;
+                    z0 += (node.Quadrant / 2) * size;
+                }
+                for (int z = z0; z < z0 + size; ++z) {
+                    for (int x = x0; x < x0 + size; ++x) {
+                        ++covered[z * quads + x];
+                    }
+                }
+            }
+            bool exact = true;
+            for (int count : covered) {
+                exact = exact && count == 1;
+            }
+            Check(exact, "the pieces of a chunk cover each quad exactly once");
+        }
+    }
+}
+
+static void TestNearestNodes() {
+    ChunkLodQuadtree lod(kChunkSize, kTerrainScale, kLeafRange);
+    std::vector<LodNode> nodes;
+    glm::vec3 camera(1.0f, 1.0f, 1.0f);
+    lod.Select(0, 0, ChunkBounds(0, 0), camera, EverythingFrustum(), nodes);
+    bool hasLeafAtCamera = false;
+    for (const LodNode& node : nodes) {
+        hasLeafAtCamera = hasLeafAtCamera || (node.Level == 0 && node.X == 0 && node.Z == 0);
+    }
+    Check(hasLeafAtCamera, "the node under the camera is drawn at full resolution");
+
+    nodes.clear();
+    lod.Select(40, 40, ChunkBounds(40, 40), camera, EverythingFrustum(), nodes);
+    Check(nodes.size() == 1 && nodes[0].Level > lod.GetChunkLevel(), "a far chunk draws its part of a block node");
+}
+
+// Selected levels of chunks sharing an edge differ by at most one, which the morph relies on
+static void TestNeighbourLevels() {
+    ChunkLodQuadtree lod(kChunkSize, kTerrainScale, kLeafRange);
+    Frustum frustum = EverythingFrustum();
+    glm::vec3 camera(3.0f, 5.0f, -7.0f);
+    const int radius = 40;
+    std::map<std::pair<int, int>, int> blockLevel;
+    for (int chunkZ = -radius; chunkZ <= radius; ++chunkZ) {
+        for (int chunkX = -radius; chunkX <= radius; ++chunkX) {
+            std::vector<LodNode> nodes;
+            lod.Select(chunkX, chunkZ, ChunkBounds(chunkX, chunkZ), camera, frustum, nodes);
+            if (nodes.size() == 1 && nodes[0].Level > lod.GetChunkLevel()) {
+                blockLevel[{ chunkX, chunkZ }] = nodes[0].Level;
+            }
+        }
+    }
+    bool adjacent = true;
+    for (const auto& [chunk, level] : blockLevel) {
+        for (auto neighbour : { std::make_pair(chunk.first + 1, chunk.second), std::make_pair(chunk.first, chunk.second + 1) }) {
+            auto found = blockLevel.find(neighbour);
+            if (found != blockLevel.end()) {
+                adjacent = adjacent && std::abs(found->second - level) <= 1;
+            }
+        }
+    }
+    Check(!blockLevel.empty(), "distant chunks use block levels");
+    Check(adjacent, "neighbouring chunks are at most one level apart");
+}
+
+static std::size_t TrianglesWithin(int radius, const glm::vec3& camera) {
+    ChunkLodQuadtree lod(kChunkSize, kTerrainScale, kLeafRange);
+    Frustum frustum = EverythingFrustum();
+    std::size_t triangles = 0;
+    for (int chunkZ = -radius; chunkZ <= radius; ++chunkZ) {
+        for (int chunkX = -radius; chunkX <= radius; ++chunkX) {
+            std::vector<LodNode> nodes;
+            lod.Select(chunkX, chunkZ, ChunkBounds(chunkX, chunkZ), camera, frustum, nodes);
+            for (const LodNode& node : nodes) {
+                triangles += lod.GetTriangleCount(node);
+            }
+        }
+    }
+    return triangles;
+}
+
+static void TestTriangleBudget() {
+    // Until the top block level is reached, each ring of chunks further out is drawn coarser,
+    // so quadrupling the area adds little
+    glm::vec3 camera(0.5f, 5.0f, 0.5f);
+    std::size_t near = TrianglesWithin(8, camera);
+    std::size_t far = TrianglesWithin(32, camera);
+    std::printf("triangles within 8 chunks: %zu, within 32 chunks: %zu\n", near, far);
+    Check(far < near * 2, "triangles grow far slower than the view area");
+}
+
+int main() {
+    TestLevels();
+    TestMorphRanges();
+    TestChunkCoverage(glm::vec3(0.5f, 5.0f, 0.5f));
+    TestChunkCoverage(glm::vec3(-20.0f, 2.0f, 13.0f));
+    TestNearestNodes();
+    TestNeighbourLevels();
+    TestTriangleBudget();
+    return TestResult("ChunkLodQuadtree");
+}
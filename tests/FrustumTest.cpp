@@ -0,0 +1,42 @@
+//
+// Created by Lucas Wang on 2024-08-18.
+//
+
+#include "Frustum.h"
+#include "TestCheck.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+static AABB Box(const glm::vec3& center, float halfSize) {
+    return AABB{ center - halfSize, center + halfSize };
+}
+
+// Camera at the origin looking down -Z, 90 degrees vertically, square viewport, depth 0.1 to 100
+static Frustum MakeFrustum() {
+    glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return Frustum(projection * view);
+}
+
+static void TestFrontAndBack() {
+    Frustum frustum = MakeFrustum();
+    Check(frustum.Intersects(Box(glm::vec3(0.0f, 0.0f, -10.0f), 1.0f)), "a box in front of the camera is visible");
+    Check(!frustum.Intersects(Box(glm::vec3(0.0f, 0.0f, 10.0f), 1.0f)), "a box behind the camera is culled");
+    Check(frustum.Intersects(Box(glm::vec3(0.0f), 1.0f)), "a box around the camera straddles the near plane and is visible");
+    Check(!frustum.Intersects(Box(glm::vec3(0.0f, 0.0f, -150.0f), 1.0f)), "a box past the far plane is culled");
+}
+
+static void TestSides() {
+    Frustum frustum = MakeFrustum();
+    // At depth 10 the 90 degree frustum reaches 10 units to either side
+    Check(!frustum.Intersects(Box(glm::vec3(20.0f, 0.0f, -10.0f), 1.0f)), "a box beyond the right plane is culled");
+    Check(!frustum.Intersects(Box(glm::vec3(0.0f, -20.0f, -10.0f), 1.0f)), "a box below the bottom plane is culled");
+    Check(frustum.Intersects(Box(glm::vec3(10.5f, 0.0f, -10.0f), 1.0f)), "a box straddling the right plane is visible");
+    Check(frustum.Intersects(AABB{ glm::vec3(-50.0f, -1.0f, -60.0f), glm::vec3(50.0f, 1.0f, -40.0f) }),
+          "a box wider than the frustum is visible");
+}
+
+int main() {
+    TestFrontAndBack();
+    TestSides();
+    return TestResult("Frustum");
+}
@@ -0,0 +1,93 @@
+//
+// Created by Lucas Wang on 2024-09-10.
+//
+
+#include "ScreenSpaceError.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+static bool Near(float a, float b) {
+    return std::abs(a - b) <= 1e-5f * std::max(1.0f, std::abs(b));
+}
+
+// A 90 degree field of view over 1000 pixels projects one world unit at distance 1 to 500 pixels
+static ScreenSpaceError MakeMetric() {
+    return ScreenSpaceError(1000.0f, glm::radians(90.0f), 2.0f);
+}
+
+static void TestProject() {
+    ScreenSpaceError metric = MakeMetric();
+    Check(Near(metric.Project(1.0f, 10.0f), 50.0f), "one unit ten units away covers 50 pixels");
+    Check(Near(metric.Project(2.0f, 10.0f), 2.0f * metric.Project(1.0f, 10.0f)), "projection grows with the error");
+    Check(Near(metric.Project(1.0f, 20.0f), 0.5f * metric.Project(1.0f, 10.0f)), "projection falls with the distance");
+    Check(std::isfinite(metric.Project(1.0f, 0.0f)), "a camera inside the bounds still projects to a finite size");
+    Check(metric.Project(0.0f, 0.0f) == 0.0f, "an exact level covers no pixels");
+}
+
+static void TestSelectLevel() {
+    ScreenSpaceError metric = MakeMetric();
+    // With a 2 pixel budget a level fits from 250 times its error away
+    std::vector<float> errors = { 0.0f, 0.1f, 0.4f, 1.6f };
+    Check(metric.SelectLevel(errors, 10.0f) == 0, "close chunks keep the finest level");
+    Check(metric.SelectLevel(errors, 25.0f) == 1, "a level is used once its error fits the budget");
+    Check(metric.SelectLevel(errors, 99.0f) == 1, "a level is not used before its error fits");
+    Check(metric.SelectLevel(errors, 100.0f) == 2, "coarser levels follow further away");
+    Check(metric.SelectLevel(errors, 1000.0f) == 3, "far chunks take the coarsest level");
+    Check(metric.SelectLevel({ 0.0f }, 1000.0f) == 0, "a single level is always picked");
+}
+
+static void TestDistance() {
+    AABB box{ glm::vec3(0.0f), glm::vec3(1.0f) };
+    Check(ScreenSpaceError::Distance(box, glm::vec3(0.5f)) == 0.0f, "points inside the box are at distance 0");
+    Check(Near(ScreenSpaceError::Distance(box, glm::vec3(4.0f, 0.5f, 0.5f)), 3.0f), "distance to a face");
+    Check(Near(ScreenSpaceError::Distance(box, glm::vec3(4.0f, 5.0f, 0.5f)), 5.0f), "distance to an edge");
+}
+
+static void TestLevelErrors() {
+    const int size = 65;
+    const int levels = 3;
+    std::vector<float> heights(size * size);
+    std::vector<float> errors;
+
+    for (int z = 0; z < size; ++z) {
+        for (int x = 0; x < size; ++x) {
+            heights[z * size + x] = 0.25f * x - 0.5f * z + 3.0f;
+        }
+    }
+    ScreenSpaceError::ComputeLevelErrors(heights.data(), size, size, levels, errors);
+    bool flat = errors.size() == levels;
+    for (float error : errors) {
+        flat = flat && error < 1e-5f;
+    }
+    Check(flat, "every level of a plane is exact");
+
+    // A spike on a vertex every level skips is the whole error from level 1 up
+    std::fill(heights.begin(), heights.end(), 0.0f);
+    heights[1 * size + 1] = 1.0f;
+    ScreenSpaceError::ComputeLevelErrors(heights.data(), size, size, levels, errors);
+    Check(errors[0] == 0.0f && Near(errors[1], 1.0f) && Near(errors[2], 1.0f), "a skipped spike is the full error");
+
+    // A spike on the top-right corner of a level 1 cell reaches its centre through the
+    // top-right to bottom-left diagonal the triangles are split along
+    std::fill(heights.begin(), heights.end(), 0.0f);
+    heights[0 * size + 2] = 1.0f;
+    ScreenSpaceError::ComputeLevelErrors(heights.data(), size, size, 2, errors);
+    Check(Near(errors[1], 0.5f), "interpolation follows the triangle split");
+
+    // Coarser levels never report less error than finer ones
+    for (int i = 0; i < size * size; ++i) {
+        heights[i] = std::sin(0.37f * (i % size)) * std::cos(0.21f * (i / size));
+    }
+    ScreenSpaceError::ComputeLevelErrors(heights.data(), size, size, levels, errors);
+    Check(errors[0] == 0.0f && errors[1] <= errors[2], "errors never decrease with the level");
+}
+
+int main() {
+    TestProject();
+    TestSelectLevel();
+    TestDistance();
+    TestLevelErrors();
+    return TestResult("ScreenSpaceError");
+}
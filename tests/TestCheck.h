@@ -0,0 +1,35 @@
+//
+// Created by Lucas Wang on 2024-09-10.
+//
+
+#ifndef TERRAINRENDERING_TESTCHECK_H
+#define TERRAINRENDERING_TESTCHECK_H
+
+#include <cstdio>
+#include <cstdlib>
+
+// Minimal checks for the CPU unit tests: each failed Check() is reported on stderr, and
+// TestResult() turns the count into the exit code CTest reads.
+inline int& TestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void Check(bool condition, const char* message) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", message);
+        ++TestFailures();
+    }
+}
+
+inline int TestResult(const char* suite) {
+    if (TestFailures() > 0) {
+        std::fprintf(stderr, "%s: %d check(s) failed\n", suite, TestFailures());
+        return EXIT_FAILURE;
+    }
+    std::printf("All %s checks passed\n", suite);
+    return EXIT_SUCCESS;
+}
+
+
+#endif //TERRAINRENDERING_TESTCHECK_H